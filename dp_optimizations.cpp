@@ -3,11 +3,15 @@
  * @brief DP optimization templates: D&C (monotone), Knuth, WQS, and CDQ
  *
  * What’s inside (straightforward functions, no heavy wrappers)
- * - Divide & Conquer Optimization (Monotone opt): one-layer solver
- * - Knuth Optimization (interval DP): O(N^2) solver
- * - WQS (Aliens trick): parametric search skeleton
- * - CDQ Divide & Conquer: generic recursion
- * - See also: Convex Hull Trick in `Template/cht.cpp:1`
+ * - Divide & Conquer Optimization (Monotone opt): one-layer solver, stack-free
+ *   and work-stealing parallel layers, K-layer driver
+ * - SMAWK (O(N) per totally monotone layer) and LARSCH-style 1D/1D solver
+ * - Knuth Optimization (interval DP): O(N^2) solver, flat triangular variant
+ * - WQS (Aliens trick): tie-safe generic drivers + CHT-based "K segments" solver
+ * - CDQ Divide & Conquer: generic recursion + bottom-up merge framework with
+ *   undo-log Fenwick (3D partial order counting)
+ * - See also: Convex Hull Trick in `interval tree/cht.cpp` (used by the WQS solver)
+ * - Benchmarks: dp_optimizations_bench.cpp (ns/state, peak RSS, cache misses)
  *
  * Conventions
  * - Use 0-based or 1-based consistently. Knuth section uses 1-based.
@@ -17,6 +21,7 @@
 
 #pragma once
 #include <bits/stdc++.h>
+#include "interval tree/cht.cpp"
 using namespace std;
 
 using ll = long long;
@@ -29,6 +34,7 @@ static constexpr ll INF64 = (ll)4e18;
  * Complexity per layer: O(N log N) for many costs; O(N) if cost queried O(1).
  * Indexing: 0-based (i in [0..N-1], j < i). You may shift to 1-based if you prefer.
  * How to use: set dp_prev, implement cost(j,i), then call dc_run_one_layer.
+ *   Or pass any functor: dc_layer(prev, cur, cost) / dc_run_layers(dp0, K, cost, threads).
  * Constraints: choose ll for costs; ensure cost only called with j<i.
  * EDIT HERE: implement cost(j,i) for your problem below.
  * ====================================================================== */
@@ -42,31 +48,315 @@ static inline ll dc_cost(int j, int i){
     return (ll)(i - j) * (i - j);
 }
 
-// Internal recursive solve for [l..r] with optimal j in [optL..optR]
+// Internal recursive solve for [l..r] with optimal j in [optL..optR].
+// cost is any callable ll(int j, int i). Reference form; dc_layer uses the
+// stack-free versions below.
+template<class Cost>
 static void dc_compute(int l, int r, int optL, int optR,
-                       const vector<ll>& dp_prev, vector<ll>& dp_cur){
+                       const ll* dp_prev, ll* dp_cur, const Cost& cost){
     if(l > r) return;
     int m = (l + r) >> 1;
     pair<ll,int> best = {INF64, max(0, min(m - 1, optL))};
     int start = optL;
     int finish = min(m - 1, optR);
     for(int j = start; j <= finish; ++j){
-        ll v = dp_prev[j] + dc_cost(j, m);
+        ll v = dp_prev[j] + cost(j, m);
         if(v < best.first){ best = {v, j}; }
     }
     dp_cur[m] = best.first;
     int opt = best.second;
-    dc_compute(l, m - 1, optL, opt, dp_prev, dp_cur);
-    dc_compute(m + 1, r, opt, optR, dp_prev, dp_cur);
+    dc_compute(l, m - 1, optL, opt, dp_prev, dp_cur, cost);
+    dc_compute(m + 1, r, opt, optR, dp_prev, dp_cur, cost);
 }
 
-// Run a single layer: fills dp_cur from dp_prev.
+// One subproblem of the recursion: rows [l..r], candidates [optL..optR].
+struct DCTask { int l, r, optL, optR; };
+
+// Solve the midpoint of t, write dp_cur[m], return opt(m).
+template<class Cost>
+static inline int dc_solve_mid(const DCTask& t, const ll* dp_prev, ll* dp_cur, const Cost& cost){
+    int m = (t.l + t.r) >> 1;
+    pair<ll,int> best = {INF64, max(0, min(m - 1, t.optL))};
+    int finish = min(m - 1, t.optR);
+    for(int j = t.optL; j <= finish; ++j){
+        ll v = dp_prev[j] + cost(j, m);
+        if(v < best.first){ best = {v, j}; }
+    }
+    dp_cur[m] = best.first;
+    return best.second;
+}
+
+// Stack-free version of dc_compute: explicit stack, no recursion depth limit.
+// stack is caller-provided scratch so repeated layers do not reallocate.
+template<class Cost>
+static void dc_compute_iter(DCTask root, const ll* dp_prev, ll* dp_cur, const Cost& cost,
+                            vector<DCTask>& stack){
+    stack.clear();
+    stack.push_back(root);
+    while(!stack.empty()){
+        DCTask t = stack.back(); stack.pop_back();
+        if(t.l > t.r) continue;
+        int m = (t.l + t.r) >> 1;
+        int opt = dc_solve_mid(t, dp_prev, dp_cur, cost);
+        stack.push_back({m + 1, t.r, opt, t.optR});
+        stack.push_back({t.l, m - 1, t.optL, opt});
+    }
+}
+
+// Scratch reused across layers by dc_run_layers: the sequential stack, the
+// per-worker task queues / stacks, and a parked thread pool. After the first
+// layer nothing is allocated and no thread is spawned.
+struct DCScratch {
+    // Owner pops the back (newest), thieves take q[head] (oldest). Storage is
+    // a vector that is only cleared when empty, so it keeps its capacity.
+    struct Worker {
+        mutex mu;
+        vector<DCTask> q, stack;
+        size_t head = 0;
+    };
+    vector<DCTask> stack;
+    unique_ptr<Worker[]> ws;
+    int nworkers = 0;
+
+    vector<thread> pool;
+    mutex mu;
+    condition_variable cv_start, cv_done;
+    long long generation = 0;
+    int running = 0;
+    bool stop = false;
+    void (*job)(void*, int) = nullptr;
+    void* job_ctx = nullptr;
+
+    DCScratch() {}
+    DCScratch(const DCScratch&) = delete;
+    DCScratch& operator=(const DCScratch&) = delete;
+    ~DCScratch(){ shutdown(); }
+
+    void shutdown(){
+        { lock_guard<mutex> g(mu); stop = true; }
+        cv_start.notify_all();
+        for(auto& th : pool) th.join();
+        pool.clear();
+        stop = false;
+    }
+
+    void ensure_workers(int threads){
+        if(nworkers == threads) return;
+        shutdown();
+        ws.reset(new Worker[threads]);
+        nworkers = threads;
+        for(int id = 1; id < threads; ++id) pool.emplace_back([this, id]{
+            long long seen = 0;
+            while(true){
+                unique_lock<mutex> lk(mu);
+                cv_start.wait(lk, [&]{ return stop || generation != seen; });
+                if(stop) return;
+                seen = generation;
+                lk.unlock();
+                job(job_ctx, id);
+                lk.lock();
+                if(--running == 0) cv_done.notify_one();
+            }
+        });
+    }
+
+    // Run fn(ctx, id) on ids 0..threads-1 (id 0 on the calling thread) and wait.
+    void run(int threads, void (*fn)(void*, int), void* ctx){
+        ensure_workers(threads);
+        {
+            lock_guard<mutex> g(mu);
+            job = fn; job_ctx = ctx;
+            running = threads - 1;
+            ++generation;
+        }
+        cv_start.notify_all();
+        fn(ctx, 0);
+        unique_lock<mutex> lk(mu);
+        cv_done.wait(lk, [&]{ return running == 0; });
+    }
+};
+
+// Work-stealing execution of one layer. Each worker owns a queue: it pops its newest
+// task (LIFO, cache-warm) and idle workers steal the oldest (largest) task of others.
+// Tasks with at most `grain` rows run sequentially via dc_compute_iter.
+// Every dp_cur[m] depends only on its own task's bounds, which are fixed by the
+// recursion tree, so the result is identical for any schedule / thread count.
+template<class Cost>
+static void dc_compute_parallel(int N, const ll* dp_prev, ll* dp_cur, const Cost& cost,
+                                int threads, int grain, DCScratch& sc){
+    sc.ensure_workers(threads);
+    DCScratch::Worker* ws = sc.ws.get();
+    for(int id = 0; id < threads; ++id){ ws[id].q.clear(); ws[id].head = 0; }
+    atomic<long long> pending{1};
+    ws[0].q.push_back({0, N - 1, 0, N - 1});
+    auto run = [&](int id){
+        while(pending.load(memory_order_acquire) > 0){
+            DCTask t; bool got = false;
+            {
+                DCScratch::Worker& w = ws[id];
+                lock_guard<mutex> g(w.mu);
+                if(w.q.size() > w.head){
+                    t = w.q.back(); w.q.pop_back(); got = true;
+                    if(w.q.size() == w.head){ w.q.clear(); w.head = 0; }
+                }
+            }
+            for(int k = 1; k < threads && !got; ++k){
+                DCScratch::Worker& v = ws[(id + k) % threads];
+                lock_guard<mutex> g(v.mu);
+                if(v.q.size() > v.head){
+                    t = v.q[v.head++]; got = true;
+                    if(v.q.size() == v.head){ v.q.clear(); v.head = 0; }
+                }
+            }
+            if(!got){ this_thread::yield(); continue; }
+            if(t.r - t.l + 1 <= grain){
+                dc_compute_iter(t, dp_prev, dp_cur, cost, ws[id].stack);
+            } else {
+                int m = (t.l + t.r) >> 1;
+                int opt = dc_solve_mid(t, dp_prev, dp_cur, cost);
+                lock_guard<mutex> g(ws[id].mu);
+                ws[id].q.push_back({m + 1, t.r, opt, t.optR});
+                ws[id].q.push_back({t.l, m - 1, t.optL, opt});
+                pending.fetch_add(2, memory_order_relaxed);
+            }
+            pending.fetch_sub(1, memory_order_release);
+        }
+    };
+    sc.run(threads, [](void* ctx, int id){ (*static_cast<decltype(run)*>(ctx))(id); }, &run);
+}
+
+// One layer with a custom cost functor: dp_cur[i] = min_{j<i} dp_prev[j] + cost(j,i).
+// dp_cur must already have size N (every index is written). threads > 1 needs -pthread
+// and a cost that is safe to call concurrently (pure reads of prefix sums are fine).
+// Pass a DCScratch to reuse buffers and threads across layers (see dc_run_layers).
+static constexpr int DC_PAR_GRAIN = 1 << 12;
+
+template<class Cost>
+static void dc_layer(const vector<ll>& dp_prev, vector<ll>& dp_cur, const Cost& cost,
+                     DCScratch& sc, int threads = 1, int grain = DC_PAR_GRAIN){
+    int N = (int)dp_prev.size();
+    assert((int)dp_cur.size() == N);
+    if(N == 0) return;
+    if(threads <= 1 || N <= grain){
+        dc_compute_iter({0, N - 1, 0, N - 1}, dp_prev.data(), dp_cur.data(), cost, sc.stack);
+    } else {
+        dc_compute_parallel(N, dp_prev.data(), dp_cur.data(), cost, threads, grain, sc);
+    }
+}
+
+template<class Cost>
+static void dc_layer(const vector<ll>& dp_prev, vector<ll>& dp_cur, const Cost& cost,
+                     int threads = 1, int grain = DC_PAR_GRAIN){
+    DCScratch sc;
+    dc_layer(dp_prev, dp_cur, cost, sc, threads, grain);
+}
+
+// Run K layers starting from dp0 (layer 0), with two rolling buffers of size N.
+// Returns the dp of layer K. Typical: dp0[i] = cost(-1 -> i) / base case, K = parts - 1.
+// One DCScratch serves all layers: no per-layer allocation or thread creation.
+template<class Cost>
+static vector<ll> dc_run_layers(vector<ll> dp0, int K, const Cost& cost, int threads = 1){
+    vector<ll> other(dp0.size());
+    DCScratch sc;
+    for(int k = 0; k < K; ++k){
+        dc_layer(dp0, other, cost, sc, threads);
+        dp0.swap(other);
+    }
+    return dp0;
+}
+
+// Run a single layer with the global dc_cost: fills dp_cur from dp_prev.
 // N is taken from dp_prev.size(). dp_cur resized to N and filled with INF64.
 static void dc_run_one_layer(const vector<ll>& dp_prev, vector<ll>& dp_cur){
     int N = (int)dp_prev.size();
     dp_cur.assign(N, INF64);
     // If your dp starts at i=1 with j<i, you can set bounds to [1..N-1]
-    if(N >= 1) dc_compute(0, N - 1, 0, N - 1, dp_prev, dp_cur);
+    dc_layer(dp_prev, dp_cur, dc_cost);
+}
+
+/* ========================================================================
+ * SMAWK / LARSCH — O(N) row minima for totally monotone layers
+ * Same form as D&C: dp_cur[i] = min_{j<i} dp_prev[j] + C(j,i), but needs the
+ * stronger assumption that C is Monge (quadrangle inequality), e.g. convex
+ * gap costs like (S[i]-S[j])^2. Then M[i][j] = dp_prev[j] + C(j,i) is
+ * totally monotone and SMAWK finds all row minima with O(N) cost calls.
+ * 1D/1D (dp[i] uses the same array, online): larsch_1d1d, O(N log N)
+ * cost calls but only the simple recursion below (no O(N) LARSCH bookkeeping).
+ * ====================================================================== */
+
+// Row minima (leftmost argmin) of a rows x cols totally monotone matrix f(i, j).
+// Returns argmin column per row; O(rows + cols) calls to f.
+template<class F>
+static vector<int> smawk(int rows, int cols, const F& f){
+    vector<int> ans(rows, 0);
+    auto rec = [&](auto&& self, const vector<int>& rs, const vector<int>& cs) -> void {
+        if(rs.empty()) return;
+        // REDUCE: keep at most |rs| columns that can still hold a row minimum
+        vector<int> st;
+        for(int c : cs){
+            while(!st.empty()){
+                int r = rs[st.size() - 1];
+                if(f(r, st.back()) <= f(r, c)) break;
+                st.pop_back();
+            }
+            if(st.size() < rs.size()) st.push_back(c);
+        }
+        vector<int> odd;
+        for(size_t i = 1; i < rs.size(); i += 2) odd.push_back(rs[i]);
+        self(self, odd, st);
+        // INTERPOLATE: even rows search between the argmins of their odd neighbours
+        size_t k = 0;
+        for(size_t i = 0; i < rs.size(); i += 2){
+            int last = i + 1 < rs.size() ? ans[rs[i + 1]] : st.back();
+            ll best = f(rs[i], st[k]); ans[rs[i]] = st[k];
+            while(st[k] != last){
+                ++k;
+                ll v = f(rs[i], st[k]);
+                if(v < best){ best = v; ans[rs[i]] = st[k]; }
+            }
+        }
+    };
+    vector<int> rs(rows), cs(cols);
+    iota(rs.begin(), rs.end(), 0);
+    iota(cs.begin(), cs.end(), 0);
+    rec(rec, rs, cs);
+    return ans;
+}
+
+// One D&C-style layer in O(N) via SMAWK. Entries j >= i are +inf (a staircase that
+// keeps the matrix totally monotone). Result matches dc_layer (unreachable -> INF64).
+template<class Cost>
+static void smawk_layer(const vector<ll>& dp_prev, vector<ll>& dp_cur, const Cost& cost){
+    int N = (int)dp_prev.size();
+    dp_cur.assign(N, INF64);
+    auto f = [&](int i, int j) -> ll { return j < i ? dp_prev[j] + cost(j, i) : LLONG_MAX; };
+    vector<int> arg = smawk(N, N, f);
+    for(int i = 1; i < N; ++i) dp_cur[i] = min(INF64, dp_prev[arg[i]] + cost(arg[i], i));
+}
+
+// 1D/1D online: dp[0] = dp0, dp[i] = min_{0<=j<i} dp[j] + cost(j,i) for i in [1, N).
+// Requires Monge cost. solve(i,k): dp[i] final, dp[k] already saw all j <= i.
+template<class Cost>
+static vector<ll> larsch_1d1d(int N, ll dp0, const Cost& cost){
+    vector<ll> dp(N, INF64);
+    vector<int> arg(N, 0);
+    if(N == 0) return dp;
+    dp[0] = dp0;
+    auto check = [&](int i, int j){
+        ll v = dp[j] + cost(j, i);
+        if(v < dp[i]){ dp[i] = v; arg[i] = j; }
+    };
+    auto solve = [&](auto&& self, int i, int k) -> void {
+        if(k - i <= 1) return;
+        int m = (i + k) >> 1;
+        for(int j = arg[i]; j <= arg[k]; ++j) check(m, j);
+        self(self, i, m);
+        for(int j = i + 1; j <= m; ++j) check(k, j);
+        self(self, m, k);
+    };
+    if(N >= 2) check(N - 1, 0); // N == 1: no j < i, never call cost(0, 0)
+    solve(solve, 0, N - 1);
+    return dp;
 }
 
 /* ========================================================================
@@ -109,6 +399,72 @@ static void knuth_solve(int N, vector<vector<ll>>& dp, vector<vector<int>>& opt)
     }
 }
 
+/* ------------------------------------------------------------------------
+ * Knuth with flat triangular storage (same recurrence, 1-based, any w functor)
+ * Only the upper triangle i <= j is stored, diagonal by diagonal:
+ *   d = j - i, entry (i,j) at d*N - d*(d-1)/2 + (i-1)
+ * so the DP (which goes len = 2..N) writes each diagonal contiguously.
+ * Memory: N(N+1)/2 ll for dp (+ int32 for opt) vs 2 full (N+2)^2 tables;
+ * N = 8000 -> 256 MB dp + 128 MB opt instead of ~768 MB.
+ * knuth_answer only returns dp[1][N] and keeps two diagonals of opt.
+ * ---------------------------------------------------------------------- */
+struct KnuthFlat {
+    int N = 0;
+    vector<ll> dp;       // triangle, see tri_idx
+    vector<int32_t> opt; // same layout (empty when not kept)
+
+    static size_t tri_idx(int N, int i, int j){
+        size_t d = (size_t)(j - i);
+        return d * N - d * (d - 1) / 2 + (size_t)(i - 1);
+    }
+    ll get(int i, int j) const { return dp[tri_idx(N, i, j)]; }
+    int get_opt(int i, int j) const { return opt[tri_idx(N, i, j)]; }
+};
+
+// Core loop. opt_prev/opt_cur hold opt of diagonals d-1 and d indexed by i;
+// if full_opt != nullptr every diagonal is also stored there.
+template<class W>
+static void knuth_flat_run(int N, const W& w, vector<ll>& dp, vector<int32_t>* full_opt){
+    dp.assign((size_t)N * (N + 1) / 2, 0);
+    if(full_opt) full_opt->assign(dp.size(), 0);
+    vector<int32_t> opt_prev(N + 2), opt_cur(N + 2);
+    for(int i = 1; i <= N; ++i){ opt_prev[i] = i; if(full_opt) (*full_opt)[i - 1] = i; }
+    for(int d = 1; d < N; ++d){
+        size_t base = (size_t)d * N - (size_t)d * (d - 1) / 2;
+        for(int i = 1; i + d <= N; ++i){
+            int j = i + d;
+            // opt[i][j-1] = opt_prev[i], opt[i+1][j] = opt_prev[i+1]
+            int s = max(opt_prev[i], i), e = min(opt_prev[i + 1], j - 1);
+            ll best = INF64; int bk = s;
+            ll wij = w(i, j);
+            for(int k = s; k <= e; ++k){
+                ll v = dp[KnuthFlat::tri_idx(N, i, k)] + dp[KnuthFlat::tri_idx(N, k + 1, j)] + wij;
+                if(v < best){ best = v; bk = k; }
+            }
+            dp[base + i - 1] = best;
+            opt_cur[i] = bk;
+            if(full_opt) (*full_opt)[base + i - 1] = bk;
+        }
+        swap(opt_prev, opt_cur);
+    }
+}
+
+template<class W>
+static KnuthFlat knuth_solve_flat(int N, const W& w){
+    KnuthFlat r; r.N = N;
+    if(N >= 1) knuth_flat_run(N, w, r.dp, &r.opt);
+    return r;
+}
+
+// dp[1][N] only; opt memory O(N)
+template<class W>
+static ll knuth_answer(int N, const W& w){
+    if(N <= 0) return 0;
+    vector<ll> dp;
+    knuth_flat_run(N, w, dp, nullptr);
+    return dp.back();
+}
+
 /* ========================================================================
  * WQS (Aliens Trick) — parametric search on lambda
  * Replace per-part cost with penalty lambda, solve unconstrained DP.
@@ -133,22 +489,99 @@ static WQSResult wqs_solve_lambda(ll lam){
     return {0, 0};
 }
 
-// Binary search λ for exactly/at-least K parts (typical variant: maximize with parts >= K)
-// Returns pair(real_answer, chosen_lambda)
-static pair<ll,ll> wqs_maximize_with_K(int K, ll lam_lo, ll lam_hi){
-    WQSResult best = {-(INF64/4), 0};
+/* ------------------------------------------------------------------------
+ * Generic WQS drivers: solve(lam) -> WQSResult, any functor.
+ *   maximize: solve returns max_x F(x) - lam*x (and an optimal x as parts)
+ *   minimize: solve returns min_x F(x) + lam*x
+ * Ties / collinear points: several x can be optimal for one lam, and solve
+ * may report any of them. The answer is therefore never read off "the lam
+ * whose parts == K". Instead (parts - K) is used as a subgradient of the
+ * dual h(lam) = val -/+ lam*K, which is convex/concave in lam, and the best
+ * h seen during the binary search is returned. This is exact whenever F is
+ * concave/convex in x; if F is integer-valued its slopes are integers, so an
+ * integer lam always reaches the optimum (no fractional lam needed).
+ * Returns {F(K), lam}. [lam_lo, lam_hi] must contain -slope of F around K.
+ * h is evaluated in __int128 (K*lam alone can exceed 2^63); solve(lam) and
+ * F(K) themselves must fit in ll.
+ * ---------------------------------------------------------------------- */
+template<class Solve>
+static pair<ll,ll> wqs_maximize(int K, ll lam_lo, ll lam_hi, const Solve& solve){
+    __int128 best = (__int128)INF64 * 4; // h may leave ll range for lam far from the optimum
+    ll bestLam = lam_lo;
+    ll lo = lam_lo, hi = lam_hi;
+    while(lo <= hi){
+        ll mid = lo + ((hi - lo) >> 1);
+        WQSResult r = solve(mid);
+        __int128 h = (__int128)r.val + (__int128)K * mid; // upper bound on F(K) for every lam
+        if(h < best){ best = h; bestLam = mid; }
+        if(r.parts == K) break;
+        if(r.parts > K) lo = mid + 1; // increase penalty to reduce parts
+        else hi = mid - 1;
+    }
+    return {(ll)best, bestLam};
+}
+
+template<class Solve>
+static pair<ll,ll> wqs_minimize(int K, ll lam_lo, ll lam_hi, const Solve& solve){
+    __int128 best = -(__int128)INF64 * 4;
     ll bestLam = lam_lo;
     ll lo = lam_lo, hi = lam_hi;
     while(lo <= hi){
-        ll mid = (lo + hi) >> 1;
-        WQSResult r = wqs_solve_lambda(mid);
-        if(r.parts >= K){
-            if(r.val > best.val){ best = r; bestLam = mid; }
-            lo = mid + 1; // increase penalty to reduce parts
-        } else hi = mid - 1;
+        ll mid = lo + ((hi - lo) >> 1);
+        WQSResult r = solve(mid);
+        __int128 h = (__int128)r.val - (__int128)K * mid; // lower bound on F(K) for every lam
+        if(h > best){ best = h; bestLam = mid; }
+        if(r.parts == K) break;
+        if(r.parts > K) lo = mid + 1;
+        else hi = mid - 1;
     }
-    ll real_ans = best.val + (ll)K * bestLam; // recover original objective
-    return {real_ans, bestLam};
+    return {(ll)best, bestLam};
+}
+
+// Binary search λ for exactly K parts with the EDIT HERE solver above
+// Returns pair(real_answer, chosen_lambda)
+static pair<ll,ll> wqs_maximize_with_K(int K, ll lam_lo, ll lam_hi){
+    return wqs_maximize(K, lam_lo, lam_hi, wqs_solve_lambda);
+}
+
+/* ------------------------------------------------------------------------
+ * Ready inner solver: split a (a_i >= 0) into segments minimizing
+ *   sum over segments of (segment sum)^2 + lam * (#segments)
+ * dp[i] = S_i^2 + lam + min_j ( -2 S_j * S_i + dp[j] + S_j^2 )
+ * Lines have non-increasing slope -2 S_j and queries x = S_i are
+ * non-decreasing, so CHTMonotone gives O(N) per lam; the line id carries j
+ * to recover the part count. With wqs_minimize: O(N log C), C = S_N^2.
+ * Overflow: keep S_N <= 1.5e9 (dp reaches S_N^2 + lam <= 2 S_N^2; the dual
+ * term K*lam is handled in __int128 by wqs_minimize).
+ * ---------------------------------------------------------------------- */
+struct WQSSegmentsSq {
+    vector<ll> S; // prefix sums, S[0] = 0
+
+    explicit WQSSegmentsSq(const vector<ll>& a) : S(a.size() + 1, 0) {
+        for(size_t i = 0; i < a.size(); ++i){ assert(a[i] >= 0); S[i + 1] = S[i] + a[i]; }
+    }
+
+    WQSResult operator()(ll lam) const {
+        int N = (int)S.size() - 1;
+        vector<ll> dp(N + 1, 0);
+        vector<int> cnt(N + 1, 0);
+        CHTMonotone cht;
+        cht.add(0, 0, 0); // j = 0: slope -2*S_0, intercept dp[0] + S_0^2
+        for(int i = 1; i <= N; ++i){
+            const LineM& ln = cht.query_line(S[i]);
+            dp[i] = ln.value(S[i]) + S[i] * S[i] + lam;
+            cnt[i] = cnt[ln.id] + 1;
+            cht.add(-2 * S[i], dp[i] + S[i] * S[i], i);
+        }
+        return {dp[N], cnt[N]};
+    }
+};
+
+// Min sum of squared segment sums over partitions of a into exactly K segments (1 <= K <= N)
+static inline ll wqs_min_segments_sq(const vector<ll>& a, int K){
+    WQSSegmentsSq solve(a);
+    ll tot = solve.S.back();
+    return wqs_minimize(K, 0, tot * tot, solve).first;
 }
 
 /* ========================================================================
@@ -173,6 +606,105 @@ static void cdq(int l, int r, Combine combine){
     cdq(m + 1, r, combine);
 }
 
+/* ------------------------------------------------------------------------
+ * CDQ framework for offline counting (no recursion, no per-level allocation)
+ * - Pairs (j, i) with j before i in `ord` (sorted by the 1st key) meet
+ *   exactly once, as (left block, right block) of a bottom-up merge sort.
+ *   Each level merges adjacent blocks by the 2nd key: on_left(x) fires when
+ *   a left element is emitted, on_right(x) for a right element, on_end()
+ *   after each block pair (e.g. Fenwick rollback). Equal 2nd key: left first.
+ * - Bottom-up order is only valid when contributions are independent
+ *   (counting/summing). If right-half values depend on finished left-half
+ *   DP values, use the recursive cdq() above.
+ * - ord / buf are the scratch arena: reused by every level; pass the same
+ *   buf to repeated calls to avoid reallocation.
+ * ---------------------------------------------------------------------- */
+
+// Fenwick (point add, prefix sum) that logs adds so they can be undone in O(#adds log n)
+struct UndoFenwick {
+    int n;
+    vector<ll> t;
+    vector<pair<int,ll>> undo;
+
+    explicit UndoFenwick(int n = 0) : n(n), t(n + 1, 0) {}
+
+    void raw_add(int i, ll v){ for(++i; i <= n; i += i & -i) t[i] += v; }
+    void add(int i, ll v){ undo.push_back({i, v}); raw_add(i, v); } // 0-based i
+    ll prefix(int i) const { // sum over [0..i]
+        ll s = 0;
+        for(++i; i > 0; i -= i & -i) s += t[i];
+        return s;
+    }
+    void rollback(){
+        for(auto& [i, v] : undo) raw_add(i, -v);
+        undo.clear();
+    }
+};
+
+template<class Less, class OnLeft, class OnRight, class OnEnd>
+static void cdq_merge_bottom_up(vector<int>& ord, vector<int>& buf, const Less& less,
+                                const OnLeft& on_left, const OnRight& on_right, const OnEnd& on_end){
+    int n = (int)ord.size();
+    buf.resize(n);
+    for(int w = 1; w < n; w <<= 1){
+        for(int l = 0; l < n; l += 2 * w){
+            int m = min(n, l + w), r = min(n, l + 2 * w);
+            int i = l, j = m, k = l;
+            if(m == r){ // lone block: nothing to pair with, just copy
+                copy(ord.begin() + l, ord.begin() + r, buf.begin() + l);
+                continue;
+            }
+            while(i < m || j < r){
+                if(j == r || (i < m && !less(ord[j], ord[i]))){ on_left(ord[i]); buf[k++] = ord[i++]; }
+                else { on_right(ord[j]); buf[k++] = ord[j++]; }
+            }
+            on_end();
+        }
+        ord.swap(buf);
+    }
+}
+
+// 3D partial order: res[i] = #{ j != i : a_j <= a_i, b_j <= b_i, c_j <= c_i }.
+// Equal points are collapsed with a weight, so duplicates count each other.
+// O(N log^2 N) time, O(N) memory; 10^6 points run without per-level allocation.
+static inline vector<int> cdq_3d_count(const vector<array<int,3>>& p){
+    int N = (int)p.size();
+    vector<int> id(N);
+    iota(id.begin(), id.end(), 0);
+    sort(id.begin(), id.end(), [&](int x, int y){ return p[x] < p[y]; });
+    vector<int> cs(N);
+    for(int i = 0; i < N; ++i) cs[i] = p[i][2];
+    sort(cs.begin(), cs.end());
+    cs.erase(unique(cs.begin(), cs.end()), cs.end());
+
+    // unique points u: b, compressed c, weight
+    vector<int> ub, uc, uw, group(N);
+    for(int t = 0; t < N; ++t){
+        int x = id[t];
+        if(t == 0 || p[x] != p[id[t - 1]]){
+            ub.push_back(p[x][1]);
+            uc.push_back(int(lower_bound(cs.begin(), cs.end(), p[x][2]) - cs.begin()));
+            uw.push_back(0);
+        }
+        uw.back()++;
+        group[x] = (int)ub.size() - 1;
+    }
+    int U = (int)ub.size();
+    vector<int> ord(U), buf;
+    iota(ord.begin(), ord.end(), 0);
+    vector<ll> got(U, 0);
+    UndoFenwick bit((int)cs.size());
+    bit.undo.reserve(U);
+    cdq_merge_bottom_up(ord, buf,
+        [&](int x, int y){ return ub[x] < ub[y]; },
+        [&](int x){ bit.add(uc[x], uw[x]); },
+        [&](int x){ got[x] += bit.prefix(uc[x]); },
+        [&]{ bit.rollback(); });
+    vector<int> res(N);
+    for(int i = 0; i < N; ++i){ int g = group[i]; res[i] = int(got[g] + uw[g] - 1); }
+    return res;
+}
+
 /* ---------------- Example usage (commented) ------------------
 int main(){
     // Example usage snippets (comment/uncomment for quick testing)
@@ -184,6 +716,11 @@ int main(){
         // EDIT HERE: precompute any prefix sums used by dc_cost()
         dc_run_one_layer(dp_prev, dp_cur);
         // dp_cur now holds dp for this layer
+
+        // K layers with a lambda cost, 4 threads (compile with -pthread)
+        vector<ll> pref(N + 1, 0); // EDIT HERE: prefix sums
+        auto cost = [&](int j, int i){ ll s = pref[i + 1] - pref[j + 1]; return s * s; };
+        vector<ll> last = dc_run_layers(dp_prev, 3, cost, 4);
     }
 
     // --- Knuth ---
@@ -193,6 +730,11 @@ int main(){
         vector<vector<ll>> dp; vector<vector<int>> opt;
         knuth_solve(N, dp, opt);
         // dp[1][N] is the answer if problem matches Knuth assumptions
+
+        // Large N: flat triangle, any functor for w
+        auto w = [&](int i, int j){ return knuth_w(i, j); };
+        KnuthFlat K = knuth_solve_flat(N, w);   // K.get(1, N), K.get_opt(i, j)
+        ll ans = knuth_answer(N, w);            // only dp[1][N], O(N) opt memory
     }
 
     // --- WQS ---
@@ -201,6 +743,10 @@ int main(){
         ll lam_lo = -1000, lam_hi = 1000; // EDIT HERE: choose adequate bounds
         auto [ans, lam] = wqs_maximize_with_K(K, lam_lo, lam_hi);
         (void)ans; (void)lam;
+
+        // Any solver functor: wqs_minimize(K, lo, hi, [&](ll lam){ ...; return WQSResult{v, parts}; })
+        vector<ll> a = {3, 1, 4, 1, 5, 9, 2, 6};
+        ll best = wqs_min_segments_sq(a, 3); // min Σ(segment sum)^2 with 3 segments
     }
 
     // --- CDQ ---
@@ -211,6 +757,33 @@ int main(){
             // e.g., sort pointers by key, use BIT to accumulate contributions
         };
         cdq(0, n - 1, combine);
+
+        // 3D partial order (dominance counting)
+        vector<array<int,3>> pts = {{1,2,3}, {2,2,3}, {0,5,1}, {2,2,3}};
+        vector<int> dominated = cdq_3d_count(pts); // {0, 2, 0, 2}
+    }
+}
+------------------------------------------------*/
+
+/* ---------------- Benchmark: D&C vs SMAWK vs 1D/1D (commented) ------------------
+int main(){
+    mt19937 rng(1);
+    for(int N : {1000, 100000, 1000000}){
+        vector<ll> pref(N + 1, 0);
+        for(int i = 0; i < N; ++i) pref[i + 1] = pref[i] + rng() % 1000;
+        auto cost = [&](int j, int i){ ll s = pref[i + 1] - pref[j + 1]; return s * s; };
+        vector<ll> prev(N), a(N), b(N);
+        for(int i = 0; i < N; ++i) prev[i] = cost(-1, i);
+        auto t0 = chrono::steady_clock::now();
+        dc_layer(prev, a, cost);
+        auto t1 = chrono::steady_clock::now();
+        smawk_layer(prev, b, cost);
+        auto t2 = chrono::steady_clock::now();
+        vector<ll> c = larsch_1d1d(N, 0, cost);
+        auto t3 = chrono::steady_clock::now();
+        auto ms = [](auto x, auto y){ return chrono::duration<double, milli>(y - x).count(); };
+        printf("N=%7d  dc %8.1f ms  smawk %8.1f ms  1d1d %8.1f ms  same=%d\n",
+               N, ms(t0, t1), ms(t1, t2), ms(t2, t3), (int)(a == b));
     }
 }
 ------------------------------------------------*/
@@ -0,0 +1,228 @@
+/**
+ * @file dp_optimizations_bench.cpp
+ * @brief Local benchmark harness for dp_optimizations.cpp (D&C, SMAWK, 1D/1D, Knuth, WQS, CDQ)
+ *
+ * Build & run (Linux, local only — not part of any submission):
+ *   g++ -O2 -std=c++17 -pthread dp_optimizations_bench.cpp -o dp_bench
+ *   ./dp_bench [max_log10 = 6] [filter substring]     // e.g. ./dp_bench 7 dc
+ *
+ * Output, one line per (benchmark, N):
+ *   name  N  time/iter  ns/state  peak RSS  cache-misses/state
+ * - Every case repeats until it has run >= 0.2 s (Google Benchmark style) and
+ *   reports the mean. "state" = one DP cell (N per layer, N^2/2 for Knuth, ...).
+ * - Peak RSS: VmHWM, reset before each case via /proc/self/clear_refs when the
+ *   kernel allows it; otherwise the process-wide high-water mark.
+ * - Cache misses: perf_event_open(PERF_COUNT_HW_CACHE_MISSES); "n/a" when perf
+ *   is unavailable (containers, perf_event_paranoid > 2, non-Linux).
+ * - Instances: random a_i in [0, 100) (S_N <= 1e9, so dp values fit in ll
+ *   at 1e7; the WQS dual K*lam is evaluated in __int128 by wqs_minimize),
+ *   cost C(j,i) = (S_i - S_j)^2 — Monge, so every technique's assumptions
+ *   hold. Instance setup is not timed. Each technique has its own size cap
+ *   (Knuth is O(N^2) memory, CDQ is O(N log^2 N)).
+ * - Sanity: the WQS case is cross-checked against dc_run_layers for
+ *   N <= 1e4 and bounded by tot^2/K <= answer <= tot^2 on every run.
+ */
+
+#include <bits/stdc++.h>
+#include "dp_optimizations.cpp"
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+/* ---------------- Measurement helpers ---------------- */
+struct PerfCounter {
+    int fd = -1;
+    PerfCounter() {
+#ifdef __linux__
+        perf_event_attr pe{};
+        pe.type = PERF_TYPE_HARDWARE;
+        pe.size = sizeof(pe);
+        pe.config = PERF_COUNT_HW_CACHE_MISSES;
+        pe.disabled = 1;
+        pe.exclude_kernel = 1;
+        pe.exclude_hv = 1;
+        pe.inherit = 1; // count worker threads too
+        fd = (int)syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+#endif
+    }
+    ~PerfCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    bool ok() const { return fd >= 0; }
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long stop() {
+        long long v = 0;
+#ifdef __linux__
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &v, sizeof(v)) != (ssize_t)sizeof(v)) return -1;
+#endif
+        return v;
+    }
+};
+
+static void reset_peak_rss() {
+#ifdef __linux__
+    if (FILE* f = fopen("/proc/self/clear_refs", "w")) { fputs("5", f); fclose(f); }
+#endif
+}
+
+static long long peak_rss_kb() {
+#ifdef __linux__
+    if (FILE* f = fopen("/proc/self/status", "r")) {
+        char line[256];
+        long long kb = -1;
+        while (fgets(line, sizeof(line), f))
+            if (sscanf(line, "VmHWM: %lld kB", &kb) == 1) break;
+        fclose(f);
+        if (kb >= 0) return kb;
+    }
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+#else
+    return -1;
+#endif
+}
+
+/* ---------------- Registry ---------------- */
+// setup(N) builds the instance (untimed) and returns the timed body, which runs one
+// iteration and returns the number of DP states it processed.
+struct Bench {
+    string name;
+    int max_log10; // size cap for this technique
+    function<function<long long()>(int)> setup;
+};
+
+static volatile ll bench_sink; // keeps results alive
+
+static vector<ll> make_prefix(int N, uint32_t seed) {
+    mt19937 rng(seed);
+    vector<ll> S(N + 1, 0);
+    for (int i = 0; i < N; ++i) S[i + 1] = S[i] + rng() % 100;
+    return S;
+}
+
+// dp_prev / cost shared by the layer benchmarks
+struct LayerInstance {
+    vector<ll> S, prev, cur;
+    explicit LayerInstance(int N) : S(make_prefix(N, 1)), prev(N), cur(N) {
+        for (int i = 0; i < N; ++i) prev[i] = S[i + 1] * S[i + 1];
+    }
+    ll cost(int j, int i) const { ll s = S[i + 1] - S[j + 1]; return s * s; }
+};
+
+static vector<Bench> make_benches() {
+    vector<Bench> bs;
+    for (int threads : {1, 4}) {
+        bs.push_back({threads == 1 ? "dc_layer" : "dc_layer_4threads", 7, [threads](int N) {
+            auto in = make_shared<LayerInstance>(N);
+            return function<long long()>([in, threads, N] {
+                dc_layer(in->prev, in->cur, [&](int j, int i) { return in->cost(j, i); }, threads);
+                bench_sink = in->cur.back();
+                return (long long)N;
+            });
+        }});
+    }
+    bs.push_back({"smawk_layer", 7, [](int N) {
+        auto in = make_shared<LayerInstance>(N);
+        return function<long long()>([in, N] {
+            smawk_layer(in->prev, in->cur, [&](int j, int i) { return in->cost(j, i); });
+            bench_sink = in->cur.back();
+            return (long long)N;
+        });
+    }});
+    bs.push_back({"larsch_1d1d", 7, [](int N) {
+        auto S = make_shared<vector<ll>>(make_prefix(N, 2));
+        return function<long long()>([S, N] {
+            auto cost = [&](int j, int i) { ll s = (*S)[i] - (*S)[j]; return s * s + 1000; };
+            bench_sink = larsch_1d1d(N + 1, 0, cost).back();
+            return (long long)N;
+        });
+    }});
+    bs.push_back({"knuth_answer", 4, [](int N) {
+        auto S = make_shared<vector<ll>>(make_prefix(N, 3));
+        return function<long long()>([S, N] {
+            auto w = [&](int i, int j) { return (*S)[j] - (*S)[i - 1]; };
+            bench_sink = knuth_answer(N, w);
+            return (long long)N * (N + 1) / 2;
+        });
+    }});
+    bs.push_back({"wqs_min_segments_sq", 7, [](int N) {
+        mt19937 rng(4);
+        auto a = make_shared<vector<ll>>(N);
+        for (auto& x : *a) x = rng() % 100;
+        int K = max(1, N / 100);
+        ll tot = accumulate(a->begin(), a->end(), 0LL);
+        if (N <= 10000) { // cross-check against K D&C layers (untimed)
+            vector<ll> S(N + 1, 0), dp0(N);
+            for (int i = 0; i < N; ++i) S[i + 1] = S[i] + (*a)[i];
+            for (int i = 0; i < N; ++i) dp0[i] = S[i + 1] * S[i + 1];
+            auto cost = [&](int j, int i) { ll s = S[i + 1] - S[j + 1]; return s * s; };
+            ll want = dc_run_layers(dp0, K - 1, cost).back();
+            if (wqs_min_segments_sq(*a, K) != want) { fprintf(stderr, "wqs mismatch at N=%d\n", N); exit(1); }
+        }
+        return function<long long()>([a, N, K, tot] {
+            ll r = wqs_min_segments_sq(*a, K);
+            // Cauchy–Schwarz: tot^2 / K <= answer <= tot^2 (catches overflow garbage)
+            if (r < tot * tot / K || r > tot * tot) { fprintf(stderr, "wqs result out of range at N=%d\n", N); exit(1); }
+            bench_sink = r;
+            return (long long)N;
+        });
+    }});
+    bs.push_back({"cdq_3d_count", 6, [](int N) {
+        mt19937 rng(5);
+        auto p = make_shared<vector<array<int,3>>>(N);
+        for (auto& x : *p) x = {int(rng() % N), int(rng() % N), int(rng() % N)};
+        return function<long long()>([p, N] {
+            bench_sink = cdq_3d_count(*p).back();
+            return (long long)N;
+        });
+    }});
+    return bs;
+}
+
+int main(int argc, char** argv) {
+    int max_log10 = argc > 1 ? atoi(argv[1]) : 6;
+    string filter = argc > 2 ? argv[2] : "";
+    PerfCounter perf;
+    printf("%-22s %10s %12s %10s %10s %14s\n", "benchmark", "N", "time/iter", "ns/state", "peakRSS", "misses/state");
+    for (auto& b : make_benches()) {
+        if (!filter.empty() && b.name.find(filter) == string::npos) continue;
+        for (int e = 3; e <= min(max_log10, b.max_log10); ++e) {
+            int N = 1;
+            for (int t = 0; t < e; ++t) N *= 10;
+            reset_peak_rss();
+            auto body = b.setup(N);
+            long long iters = 0, states = 0, misses = 0;
+            double secs = 0;
+            while (secs < 0.2) {
+                perf.start();
+                auto st = chrono::steady_clock::now();
+                states += body();
+                secs += chrono::duration<double>(chrono::steady_clock::now() - st).count();
+                long long m = perf.stop();
+                misses = (m < 0 || misses < 0) ? -1 : misses + m;
+                ++iters;
+            }
+            char miss_buf[32] = "n/a";
+            if (perf.ok() && misses >= 0) snprintf(miss_buf, sizeof(miss_buf), "%.3f", (double)misses / states);
+            printf("%-22s %10d %10.3fms %10.2f %8lldMB %14s\n", b.name.c_str(), N, secs * 1e3 / iters,
+                   secs * 1e9 / states, peak_rss_kb() / 1024, miss_buf);
+            fflush(stdout);
+        }
+    }
+}
@@ -31,7 +31,7 @@ struct Line {
 };
 
 struct LineContainer : multiset<Line, less<>> {
-    static constexpr long double INF = 1e400;
+    static constexpr long double INF = numeric_limits<long double>::infinity();
 
     // Compute intersection of line x and y, store in x->x
     long double isect(iterator x, iterator y) {
@@ -70,12 +70,13 @@ struct LineContainer : multiset<Line, less<>> {
 /**
  * For monotone queries and lines (O(1) amortized).
  * Add lines with monotonic slopes and query with monotonic x.
- * Default: MIN queries, slopes increasing, x non-decreasing.
+ * Default: MIN queries, slopes non-increasing (equal slopes allowed), x non-decreasing.
  */
 struct LineM {
     long long a, b;
     long double interX;
-    LineM(long long A=0, long long B=0, long double X=-1e400) : a(A), b(B), interX(X) {}
+    int id; // caller payload (e.g. DP index the line came from)
+    LineM(long long A=0, long long B=0, long double X=-numeric_limits<long double>::infinity(), int Id=0) : a(A), b(B), interX(X), id(Id) {}
     long long value(long long x) const { return a * x + b; }
 };
 
@@ -88,9 +89,13 @@ struct CHTMonotone {
              <= (__int128)(l2.b - l1.b) * (l1.a - l3.a);
     }
 
-    // Add line with slope a (increasing)
-    void add(long long a, long long b) {
-        LineM nl(a, b);
+    // Add line with slope a (non-increasing for min); id is returned by query_line
+    void add(long long a, long long b, int id = 0) {
+        LineM nl(a, b); nl.id = id;
+        if (!dq.empty() && dq.back().a == a) {  // parallel: keep the lower one
+            if (dq.back().b <= b) return;
+            dq.pop_back();
+        }
         while (dq.size() >= 2 && bad(dq[dq.size()-2], dq.back(), nl)) dq.pop_back();
         if (!dq.empty()) {
             long double x = (long double)(dq.back().b - nl.b) / (nl.a - dq.back().a);
@@ -100,9 +105,12 @@ struct CHTMonotone {
     }
 
     // Query min at x, assuming x non-decreasing
-    long long query(long long x) {
+    long long query(long long x) { return query_line(x).value(x); }
+
+    // Line attaining the min at x (to read its id), same monotone assumption
+    const LineM& query_line(long long x) {
         while (dq.size() >= 2 && dq[1].interX <= x) dq.pop_front();
-        return dq.front().value(x);
+        return dq.front();
     }
 };
 
@@ -112,9 +120,9 @@ int main() {
     lc.add(2, 3); lc.add(-1, 5);
     cout << lc.query(4) << "\n";
 
-    CHTMonotone cht; // monotone DP hull (min)
-    cht.add(-5, 10);
+    CHTMonotone cht; // monotone DP hull (min), slopes added in non-increasing order
     cht.add(-2, 4);
-    cout << cht.query(3) << "\n";
+    cht.add(-5, 10);
+    cout << cht.query(3) << "\n"; // -5
 }
 ------------------------------------------------*/  
\ No newline at end of file
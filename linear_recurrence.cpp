@@ -0,0 +1,156 @@
+/**
+ * @file linear_recurrence.cpp
+ * @brief Truy hồi tuyến tính: số hạng thứ n (Bostan–Mori) + tìm lại truy hồi (Berlekamp–Massey)
+ *
+ * Mục tiêu
+ * - Thay cho T.pow(n) của Mat (O(k^3 log n)) khi chỉ cần một số hạng của truy hồi bậc k:
+ *     a_i = c_1*a_{i-1} + c_2*a_{i-2} + ... + c_k*a_{i-k}
+ * - linear_rec_nth: O(k^2 log n) với mọi Mint; O(k log k log n) khi MOD = 998244353 (NTT).
+ * - berlekamp_massey: từ 2k số hạng đầu tìm truy hồi ngắn nhất, O(N^2) (MOD nguyên tố).
+ *
+ * Quy ước
+ * - Dùng chung kiểu Mint với Mat (modint.cpp): mint107, mint998, dmint, ...
+ * - c[0..k-1] = c_1..c_k; init[0..k-1] = a_0..a_{k-1}; chỉ số n tính từ 0.
+ */
+
+#pragma once
+#include <bits/stdc++.h>
+#include "modint.cpp"
+using namespace std;
+
+/* ========================================================================
+ * 1) Nhân đa thức: NTT nếu MOD = 998244353 và đủ lớn, ngược lại nhân trực tiếp
+ *    (cộng dồn rep*rep trong u64, rút gọn mỗi lazy_terms() số hạng).
+ * ====================================================================== */
+template<class Mint>
+void ntt(vector<Mint>& a, bool invert) {
+    int n = (int)a.size();
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) swap(a[i], a[j]);
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        Mint w = Mint(3).pow((Mint::mod() - 1) / len);
+        if (invert) w = w.inv();
+        int half = len >> 1;
+        vector<Mint> ws(half);
+        ws[0] = 1;
+        for (int i = 1; i < half; i++) ws[i] = ws[i - 1] * w;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < half; j++) {
+                Mint u = a[i + j], v = a[i + j + half] * ws[j];
+                a[i + j] = u + v;
+                a[i + j + half] = u - v;
+            }
+        }
+    }
+    if (invert) {
+        Mint inv_n = Mint(n).inv();
+        for (auto& x : a) x *= inv_n;
+    }
+}
+
+template<class Mint>
+vector<Mint> poly_mul(const vector<Mint>& a, const vector<Mint>& b) {
+    if (a.empty() || b.empty()) return {};
+    int need = (int)(a.size() + b.size() - 1);
+    if (Mint::mod() == 998244353 && min(a.size(), b.size()) > 32) {
+        int sz = 1;
+        while (sz < need) sz <<= 1;
+        vector<Mint> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+        fa.resize(sz); fb.resize(sz);
+        ntt(fa, false); ntt(fb, false);
+        for (int i = 0; i < sz; i++) fa[i] *= fb[i];
+        ntt(fa, true);
+        fa.resize(need);
+        return fa;
+    }
+    const int lazy = Mint::lazy_terms();
+    vector<Mint> res(need);
+    for (int t = 0; t < need; t++) {
+        int lo = max(0, t - (int)b.size() + 1), hi = min(t, (int)a.size() - 1);
+        for (int i0 = lo; i0 <= hi; i0 += lazy) {
+            int i1 = min(hi + 1, i0 + lazy);
+            unsigned long long sum = 0;
+            for (int i = i0; i < i1; i++) sum += (unsigned long long)a[i].rep() * b[t - i].rep();
+            res[t] += Mint::from_sum(sum);
+        }
+    }
+    return res;
+}
+
+/* ========================================================================
+ * 2) linear_rec_nth — a_n của truy hồi bậc k (Bostan–Mori)
+ *    a_n = [x^n] P(x)/Q(x), Q = 1 - c_1 x - ... - c_k x^k, P = (A*Q) mod x^k.
+ *    Mỗi bước: nhân tử và mẫu với Q(-x), giữ hệ số chẵn/lẻ theo bit thấp của n -> n/2.
+ * ====================================================================== */
+template<class Mint>
+Mint linear_rec_nth(const vector<Mint>& c, const vector<Mint>& init, unsigned long long n) {
+    int k = (int)c.size();
+    assert((int)init.size() >= k);
+    if (n < init.size()) return init[n];
+    if (k == 0) return Mint(0);
+    vector<Mint> Q(k + 1);
+    Q[0] = 1;
+    for (int i = 0; i < k; i++) Q[i + 1] = -c[i];
+    vector<Mint> P = poly_mul(vector<Mint>(init.begin(), init.begin() + k), Q);
+    P.resize(k);
+    while (n) {
+        vector<Mint> Qm = Q;
+        for (int i = 1; i <= k; i += 2) Qm[i] = -Qm[i];
+        vector<Mint> U = poly_mul(P, Qm), V = poly_mul(Q, Qm);
+        for (int i = 0; i < k; i++) P[i] = 2 * i + (int)(n & 1) < (int)U.size() ? U[2 * i + (n & 1)] : Mint(0);
+        for (int i = 0; i <= k; i++) Q[i] = V[2 * i];
+        n >>= 1;
+    }
+    return P[0] / Q[0];
+}
+
+/* ========================================================================
+ * 3) berlekamp_massey — truy hồi ngắn nhất sinh ra dãy s
+ *    Trả về c (c_1..c_L) với s_i = Σ c_j s_{i-j} cho mọi i >= L.
+ *    Cần ít nhất 2L số hạng để chắc chắn đúng.
+ * ====================================================================== */
+template<class Mint>
+vector<Mint> berlekamp_massey(const vector<Mint>& s) {
+    vector<Mint> C = {1}, B = {1};
+    int L = 0, m = 1;
+    Mint b = 1;
+    for (int i = 0; i < (int)s.size(); i++) {
+        Mint d = 0;
+        for (int j = 0; j <= L; j++) d += C[j] * s[i - j];
+        if (d == Mint(0)) { m++; continue; }
+        vector<Mint> T = C;
+        Mint coef = d / b;
+        if (C.size() < B.size() + m) C.resize(B.size() + m);
+        for (int j = 0; j < (int)B.size(); j++) C[j + m] -= coef * B[j];
+        if (2 * L <= i) { L = i + 1 - L; B = T; b = d; m = 1; }
+        else m++;
+    }
+    C.resize(L + 1);
+    vector<Mint> c(L);
+    for (int j = 0; j < L; j++) c[j] = -C[j + 1];
+    return c;
+}
+
+// Đoán truy hồi từ các số hạng đầu rồi tính a_n
+template<class Mint>
+Mint guess_nth_term(const vector<Mint>& s, unsigned long long n) {
+    if (n < s.size()) return s[n];
+    vector<Mint> c = berlekamp_massey(s);
+    return linear_rec_nth(c, vector<Mint>(s.begin(), s.begin() + c.size()), n);
+}
+
+/* ---------------- Ví dụ sử dụng ------------------
+int main(){
+    // Fibonacci: a_i = a_{i-1} + a_{i-2}, a_0 = 0, a_1 = 1
+    vector<mint107> c = {1, 1}, init = {0, 1};
+    cout << linear_rec_nth(c, init, 1000000000000000000ULL) << "\n";
+
+    // Chỉ có các số hạng đầu (vd từ DP brute-force nhỏ): BM tự tìm truy hồi
+    vector<mint998> s = {1, 1, 2, 3, 5, 8, 13, 21, 34, 55};
+    cout << guess_nth_term(s, 100) << "\n";   // F_101 mod 998244353
+}
+------------------------------------------------*/
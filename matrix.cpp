@@ -1,42 +1,138 @@
-// Matrix Multiplication (0-indexed, dynamic size, modulo)
+// Matrix Multiplication (0-indexed, dynamic size, modulo qua kiểu Mint)
 // CP-friendly: identity, multiply, fast exponent, vector multiply
 
+#pragma once
 #include <bits/stdc++.h>
+#include "modint.cpp"
+#include "linear_recurrence.cpp"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define MAT_HAS_X86 1
+#endif
 using namespace std;
 
-constexpr long long MOD = 1000000007LL; // đổi tuỳ bài (vd: 998244353)
+/* ------------------------------------------------------------------------
+ * Kernel: Ci[j] += Σ_{k0<=k<k1} Ai[k] * B[k][j] với j in [j0, j1)  (u32 * u32 -> u64)
+ * Bản AVX2 giữ 16 cột của Ci trong 4 thanh ghi ymm suốt khối k, chọn lúc chạy theo CPU.
+ * ---------------------------------------------------------------------- */
+static inline void mat_kernel_scalar(const uint32_t* Ai, const uint32_t* B, int n,
+                                     int k0, int k1, int j0, int j1, unsigned long long* Ci) {
+    for (int k = k0; k < k1; k++) {
+        unsigned long long Aik = Ai[k];
+        if (!Aik) continue;
+        const uint32_t* Bk = B + (size_t)k * n;
+        for (int j = j0; j < j1; j++) Ci[j] += Aik * Bk[j];
+    }
+}
+
+#ifdef MAT_HAS_X86
+__attribute__((target("avx2")))
+static inline void mat_kernel_avx2(const uint32_t* Ai, const uint32_t* B, int n,
+                                   int k0, int k1, int j0, int j1, unsigned long long* Ci) {
+    int j = j0;
+    for (; j + 16 <= j1; j += 16) {
+        __m256i c0 = _mm256_loadu_si256((const __m256i*)(Ci + j));
+        __m256i c1 = _mm256_loadu_si256((const __m256i*)(Ci + j + 4));
+        __m256i c2 = _mm256_loadu_si256((const __m256i*)(Ci + j + 8));
+        __m256i c3 = _mm256_loadu_si256((const __m256i*)(Ci + j + 12));
+        for (int k = k0; k < k1; k++) {
+            if (!Ai[k]) continue;
+            __m256i x = _mm256_set1_epi64x(Ai[k]);
+            const uint32_t* Bk = B + (size_t)k * n + j;
+            __m256i b0 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)(Bk)));
+            __m256i b1 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)(Bk + 4)));
+            __m256i b2 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)(Bk + 8)));
+            __m256i b3 = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i*)(Bk + 12)));
+            c0 = _mm256_add_epi64(c0, _mm256_mul_epu32(x, b0));
+            c1 = _mm256_add_epi64(c1, _mm256_mul_epu32(x, b1));
+            c2 = _mm256_add_epi64(c2, _mm256_mul_epu32(x, b2));
+            c3 = _mm256_add_epi64(c3, _mm256_mul_epu32(x, b3));
+        }
+        _mm256_storeu_si256((__m256i*)(Ci + j), c0);
+        _mm256_storeu_si256((__m256i*)(Ci + j + 4), c1);
+        _mm256_storeu_si256((__m256i*)(Ci + j + 8), c2);
+        _mm256_storeu_si256((__m256i*)(Ci + j + 12), c3);
+    }
+    if (j < j1) mat_kernel_scalar(Ai, B, n, k0, k1, j, j1, Ci);
+}
+#endif
+
+static inline bool mat_cpu_has_avx2() {
+#ifdef MAT_HAS_X86
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
 
+// Mint: MontgomeryModint<MOD> (MOD cố định) hoặc DynamicModint<id> (MOD đặt lúc chạy), xem modint.cpp
+template<class Mint>
 struct Mat {
+    using u32 = uint32_t;
+    using u64 = unsigned long long;
+    static_assert(sizeof(Mint) == sizeof(u32), "Mint phải chỉ gồm một rep u32");
+
+    static constexpr int TILE_J = 128; // số cột mỗi tile (tile k x j của B nằm gọn trong L1)
+
+    // true: dùng kernel AVX2 (mặc định nếu CPU hỗ trợ); đặt false để ép bản scalar
+    static inline bool use_simd = mat_cpu_has_avx2();
+
+    // Số luồng cho phép nhân (chia theo khối hàng); chỉ bật khi n >= PAR_MIN_N.
+    // vd: Mat<mint107>::threads = thread::hardware_concurrency(); (biên dịch kèm -pthread)
+    static inline int threads = 1;
+    static constexpr int PAR_MIN_N = 128;
+
     int n;
-    vector<vector<long long>> a; // 0-indexed: a[i][j]
+    vector<Mint> a; // row-major phẳng: phần tử (i, j) ở a[i*n + j]
 
-    Mat(int n = 0, bool ident = false) : n(n), a(n, vector<long long>(n, 0)) {
+    Mat(int n = 0, bool ident = false) : n(n), a((size_t)n * n) {
         if (ident) {
-            for (int i = 0; i < n; i++) a[i][i] = 1;
+            for (int i = 0; i < n; i++) a[(size_t)i * n + i] = 1;
         }
     }
 
     static Mat identity(int n) { return Mat(n, true); }
 
+    // M[i][j] như mảng 2 chiều (trả về con trỏ tới đầu hàng i)
+    Mint* operator[](int i) { return a.data() + (size_t)i * n; }
+    const Mint* operator[](int i) const { return a.data() + (size_t)i * n; }
+
+    // Dãy rep() của hàng i (dùng trong vòng lặp nóng)
+    const u32* rep_row(int i) const { return reinterpret_cast<const u32*>(a.data()) + (size_t)i * n; }
+
     Mat& operator*=(const Mat& o) {
         assert(n == o.n);
-        Mat r(n);
-        for (int i = 0; i < n; i++) {
-            const auto& Ai = a[i];
-            auto& Ri = r.a[i];
-            for (int k = 0; k < n; k++) {
-                long long Aik = Ai[k];
-                if (!Aik) continue;
-                const auto& Bk = o.a[k];
-                unsigned long long mul = 0;
-                for (int j = 0; j < n; j++) {
-                    if (!Bk[j]) continue;
-                    Ri[j] += (Aik * Bk[j]) % MOD;
-                    if (Ri[j] >= MOD) Ri[j] -= MOD;
+        // Chia k thành khối lazy hàng (trễ phép rút gọn), j thành tile TILE_J cột.
+        // acc cộng dồn rep*rep trong u64, cuối mỗi khối k mới đổi sang Mint bằng from_sum.
+        const int lazy = Mint::lazy_terms();
+        auto kernel = mat_kernel_scalar;
+#ifdef MAT_HAS_X86
+        if (use_simd) kernel = mat_kernel_avx2;
+#endif
+        const u32* B = o.rep_row(0);
+        vector<u64> acc((size_t)n * n, 0);
+        vector<Mint> r((size_t)n * n);
+        // Mỗi luồng xử lý trọn các hàng [i0, i1): các hàng độc lập nên không cần đồng bộ.
+        auto run_rows = [&](int i0, int i1) {
+            for (int k0 = 0; k0 < n; k0 += lazy) {
+                int k1 = min(n, k0 + lazy);
+                for (int j0 = 0; j0 < n; j0 += TILE_J) {
+                    int j1 = min(n, j0 + TILE_J);
+                    for (int i = i0; i < i1; i++)
+                        kernel(rep_row(i), B, n, k0, k1, j0, j1, acc.data() + (size_t)i * n);
                 }
+                for (size_t t = (size_t)i0 * n; t < (size_t)i1 * n; t++) { r[t] += Mint::from_sum(acc[t]); acc[t] = 0; }
             }
+        };
+        int T = n >= PAR_MIN_N ? max(1, min(threads, n)) : 1;
+        if (T == 1) run_rows(0, n);
+        else {
+            vector<thread> pool;
+            for (int t = 0; t < T; t++) pool.emplace_back(run_rows, (int)((long long)n * t / T), (int)((long long)n * (t + 1) / T));
+            for (auto& th : pool) th.join();
         }
-        return (*this = r);
+        a.swap(r);
+        return *this;
     }
 
     friend Mat operator*(Mat l, const Mat& r) { l *= r; return l; }
@@ -46,23 +142,561 @@ struct Mat {
         Mat res = identity(n);
         while (e > 0) {
             if (e & 1) res = res * base;
-            base = base * base;
             e >>= 1;
+            if (e) base = base * base;
         }
         return res;
     }
 
-    vector<long long> mulVec(const vector<long long>& v) const {
+    vector<Mint> mulVec(const vector<Mint>& v) const {
         assert((int)v.size() == n);
-        vector<long long> res(n, 0);
+        const int lazy = Mint::lazy_terms();
+        vector<Mint> res(n);
         for (int i = 0; i < n; i++) {
-            unsigned long long sum = 0;
-            for (int j = 0; j < n; j++) {
-                if (!a[i][j]) continue;
-                sum += (unsigned long long)a[i][j] * (unsigned long long)v[j] % MOD;
-                if (sum >= (1ull << 62)) sum %= MOD; // tránh tràn tạm thời
+            const u32* Ai = rep_row(i);
+            for (int j0 = 0; j0 < n; j0 += lazy) {
+                int j1 = min(n, j0 + lazy);
+                u64 sum = 0;
+                for (int j = j0; j < j1; j++) sum += (u64)Ai[j] * v[j].rep();
+                res[i] += Mint::from_sum(sum);
             }
-            res[i] = (long long)(sum % MOD);
+        }
+        return res;
+    }
+};
+
+// Khử Gauss–Jordan trên bảng phẳng rows x cols (row-major), chỉ chọn trụ ở cột < var_cols.
+// Trả về hạng; pivots[r] = cột trụ của hàng r; det nhân dồn các trụ và dấu hoán vị.
+// Chia cột thành panel b <= lazy_terms() cột: khử ngay trong panel, đồng thời ghi hệ số
+// C[i][t] để hàng i = (hàng cũ nếu không là trụ) + Σ_t C[i][t] * (hàng trụ thứ t ban đầu).
+// Phần cột sau panel cập nhật một lần bằng kernel nhân ma trận (u64 trễ rút gọn, AVX2),
+// mỗi phần tử chỉ một from_sum cho cả panel thay vì b phép nhân Mint.
+template<class Mint>
+int gauss_jordan(vector<Mint>& a, int rows, int cols, int var_cols, vector<int>* pivots = nullptr, Mint* det = nullptr) {
+    using u32 = uint32_t;
+    using u64 = unsigned long long;
+    static_assert(sizeof(Mint) == sizeof(u32), "Mint phải chỉ gồm một rep u32");
+    const int b = min(32, Mint::lazy_terms());
+    auto kernel = mat_kernel_scalar;
+#ifdef MAT_HAS_X86
+    if (Mat<Mint>::use_simd) kernel = mat_kernel_avx2;
+#endif
+    vector<Mint> C((size_t)rows * b);   // hệ số theo các hàng trụ của panel
+    vector<char> base(rows);            // 1: hàng vẫn giữ phần hàng cũ của nó
+    vector<u32> P;                      // phần sau panel của các hàng trụ (bản gốc)
+    vector<u64> acc;
+    Mint d = 1;
+    int r = 0;
+    for (int c0 = 0; c0 < var_cols && r < rows; c0 += b) {
+        int c1 = min(var_cols, c0 + b), r0 = r, k = 0;
+        fill(C.begin(), C.end(), Mint(0));
+        fill(base.begin(), base.end(), 1);
+        for (int c = c0; c < c1 && r < rows; c++) {
+            int p = r;
+            while (p < rows && a[(size_t)p * cols + c] == Mint(0)) p++;
+            if (p == rows) { d = 0; continue; }
+            Mint* R = a.data() + (size_t)r * cols;
+            if (p != r) {
+                swap_ranges(R + c0, R + cols, a.data() + (size_t)p * cols + c0);
+                swap_ranges(C.begin() + (size_t)r * b, C.begin() + (size_t)(r + 1) * b, C.begin() + (size_t)p * b);
+                d = -d;
+            }
+            Mint* Cr = C.data() + (size_t)r * b;
+            Cr[k] += 1; base[r] = 0;
+            d *= R[c];
+            Mint inv = R[c].inv();
+            for (int j = c; j < c1; j++) R[j] *= inv;
+            for (int t = 0; t <= k; t++) Cr[t] *= inv;
+            for (int i = 0; i < rows; i++) {
+                if (i == r) continue;
+                Mint* X = a.data() + (size_t)i * cols;
+                Mint f = X[c];
+                if (f == Mint(0)) continue;
+                for (int j = c; j < c1; j++) X[j] -= f * R[j];
+                Mint* Ci = C.data() + (size_t)i * b;
+                for (int t = 0; t <= k; t++) Ci[t] -= f * Cr[t];
+            }
+            if (pivots) pivots->push_back(c);
+            r++; k++;
+        }
+        int T = cols - c1;
+        if (k == 0 || T == 0) continue;
+        P.resize((size_t)k * T);
+        for (int t = 0; t < k; t++) {
+            const Mint* src = a.data() + (size_t)(r0 + t) * cols + c1;
+            for (int j = 0; j < T; j++) P[(size_t)t * T + j] = src[j].rep();
+        }
+        acc.resize(T);
+        for (int i = 0; i < rows; i++) {
+            const u32* Ci = reinterpret_cast<const u32*>(C.data()) + (size_t)i * b;
+            if (base[i] && all_of(Ci, Ci + k, [](u32 x) { return x == 0; })) continue;
+            fill(acc.begin(), acc.end(), 0);
+            kernel(Ci, P.data(), T, 0, k, 0, T, acc.data());
+            Mint* X = a.data() + (size_t)i * cols + c1;
+            for (int j = 0; j < T; j++) X[j] = (base[i] ? X[j] : Mint(0)) + Mint::from_sum(acc[j]);
+        }
+    }
+    if (det) *det = r == var_cols ? d : Mint(0);
+    return r;
+}
+
+template<class Mint>
+int mat_rank(const Mat<Mint>& A) {
+    vector<Mint> a = A.a;
+    return gauss_jordan(a, A.n, A.n, A.n);
+}
+
+template<class Mint>
+Mint mat_det(const Mat<Mint>& A) {
+    vector<Mint> a = A.a;
+    Mint d;
+    gauss_jordan(a, A.n, A.n, A.n, nullptr, &d);
+    return d;
+}
+
+// Nghịch đảo qua [A | I]; trả về false nếu A suy biến
+template<class Mint>
+bool mat_inverse(const Mat<Mint>& A, Mat<Mint>& inv) {
+    int n = A.n;
+    vector<Mint> a((size_t)n * 2 * n);
+    for (int i = 0; i < n; i++) {
+        copy(A[i], A[i] + n, a.begin() + (size_t)i * 2 * n);
+        a[(size_t)i * 2 * n + n + i] = 1;
+    }
+    if (gauss_jordan(a, n, 2 * n, n) < n) return false;
+    inv = Mat<Mint>(n);
+    for (int i = 0; i < n; i++) copy(a.begin() + (size_t)i * 2 * n + n, a.begin() + (size_t)(i + 1) * 2 * n, inv[i]);
+    return true;
+}
+
+// Giải A x = b; trả về false nếu vô nghiệm. Nếu vô số nghiệm: x là một nghiệm (biến tự do = 0).
+template<class Mint>
+bool mat_solve(const Mat<Mint>& A, const vector<Mint>& b, vector<Mint>& x) {
+    int n = A.n;
+    assert((int)b.size() == n);
+    vector<Mint> a((size_t)n * (n + 1));
+    for (int i = 0; i < n; i++) {
+        copy(A[i], A[i] + n, a.begin() + (size_t)i * (n + 1));
+        a[(size_t)i * (n + 1) + n] = b[i];
+    }
+    vector<int> piv;
+    int r = gauss_jordan(a, n, n + 1, n, &piv);
+    for (int i = r; i < n; i++)
+        if (a[(size_t)i * (n + 1) + n] != Mint(0)) return false;
+    x.assign(n, Mint(0));
+    for (int i = 0; i < r; i++) x[piv[i]] = a[(size_t)i * (n + 1) + n];
+    return true;
+}
+
+// Hệ phương trình XOR (GF(2)) rows x cols, mỗi hàng nén bit thành W từ u64 (cột cols là vế phải).
+// Khử một hàng = XOR W - c/64 từ, nên 10^4 x 10^4 chạy cỡ 10^4 * 10^4 * 157 / 2 phép u64.
+struct XorSystem {
+    int rows, cols, W;
+    vector<uint64_t> a;
+
+    XorSystem(int rows, int cols) : rows(rows), cols(cols), W((cols + 64) >> 6), a((size_t)rows * W, 0) {}
+
+    uint64_t* row(int i) { return a.data() + (size_t)i * W; }
+    bool get(int i, int j) const { return a[(size_t)i * W + (j >> 6)] >> (j & 63) & 1; }
+    void set(int i, int j, bool v = true) {
+        uint64_t& w = a[(size_t)i * W + (j >> 6)];
+        if (v) w |= 1ULL << (j & 63); else w &= ~(1ULL << (j & 63));
+    }
+    void set_rhs(int i, bool v) { set(i, cols, v); }
+
+    // Gauss–Jordan tại chỗ; trả về hạng, pivots[r] = cột trụ của hàng r
+    int eliminate(vector<int>* pivots = nullptr) {
+        int r = 0;
+        for (int c = 0; c < cols && r < rows; c++) {
+            int p = r;
+            while (p < rows && !get(p, c)) p++;
+            if (p == rows) continue;
+            int w0 = c >> 6;
+            if (p != r) swap_ranges(row(r) + w0, row(r) + W, row(p) + w0);
+            const uint64_t* R = row(r);
+            for (int i = 0; i < rows; i++) {
+                if (i == r || !get(i, c)) continue;
+                uint64_t* X = row(i);
+                for (int w = w0; w < W; w++) X[w] ^= R[w];
+            }
+            if (pivots) pivots->push_back(c);
+            r++;
+        }
+        return r;
+    }
+
+    // Một nghiệm x (biến tự do = 0); false nếu vô nghiệm. Làm thay đổi hệ.
+    bool solve(vector<int>& x) {
+        vector<int> piv;
+        int r = eliminate(&piv);
+        for (int i = r; i < rows; i++)
+            if (get(i, cols)) return false;
+        x.assign(cols, 0);
+        for (int i = 0; i < r; i++) x[piv[i]] = get(i, cols);
+        return true;
+    }
+};
+
+// Bảng luỹ thừa cho nhiều truy vấn T^e * v cùng T: lưu T^(d * b^i) với b = 2^LOG_B, d in [1, b).
+// Tiền xử lý: (b-1) * ceil(bits / LOG_B) phép nhân ma trận; bộ nhớ tương ứng số ma trận đó.
+// Mỗi truy vấn: mỗi chữ số khác 0 của e (cơ số b) là một mulVec, O(n^2 * bits / LOG_B).
+template<class Mint>
+struct MatPowTable {
+    int n, LOG_B, levels;
+    vector<vector<Mat<Mint>>> P; // P[i][d-1] = T^(d * b^i)
+
+    // max_e: số mũ lớn nhất sẽ hỏi; LOG_B lớn -> truy vấn nhanh hơn, tốn bộ nhớ (b-1 ma trận/mức)
+    MatPowTable(const Mat<Mint>& T, unsigned long long max_e, int LOG_B = 1) : n(T.n), LOG_B(LOG_B), levels(0) {
+        assert(1 <= LOG_B && LOG_B <= 8);
+        int bits = 64 - __builtin_clzll(max_e | 1);
+        levels = (bits + LOG_B - 1) / LOG_B;
+        int b = 1 << LOG_B;
+        Mat<Mint> step = T; // T^(b^i)
+        for (int i = 0; i < levels; i++) {
+            vector<Mat<Mint>> row;
+            row.push_back(step);
+            for (int d = 2; d < b; d++) row.push_back(row.back() * step);
+            if (i + 1 < levels) step = row.back() * step;
+            P.push_back(move(row));
+        }
+    }
+
+    // T^e * v; e <= max_e lúc dựng bảng (các T^(...) giao hoán nên thứ tự nhân không quan trọng)
+    vector<Mint> apply(unsigned long long e, vector<Mint> v) const {
+        assert((int)v.size() == n);
+        int mask = (1 << LOG_B) - 1;
+        for (int i = 0; e; i++, e >>= LOG_B) {
+            assert(i < levels);
+            if (int d = (int)(e & mask)) v = P[i][d - 1].mulVec(v);
+        }
+        return v;
+    }
+};
+
+// Ma trận kích thước cố định N (std::array, không cấp phát heap), cùng giao diện với Mat.
+// Mọi phép toán là constexpr: với Mint = MontgomeryModint, pow tính được lúc biên dịch.
+// N <= 8: vòng lặp có cận hằng được trình biên dịch trải phẳng hoàn toàn.
+template<int N, class Mint>
+struct StaticMat {
+    static constexpr int n = N;
+    array<Mint, N * N> a{}; // row-major phẳng như Mat
+
+    constexpr StaticMat() {}
+    constexpr explicit StaticMat(bool ident) {
+        if (ident)
+            for (int i = 0; i < N; i++) a[i * N + i] = 1;
+    }
+
+    static constexpr StaticMat identity() { return StaticMat(true); }
+
+    constexpr Mint* operator[](int i) { return a.data() + i * N; }
+    constexpr const Mint* operator[](int i) const { return a.data() + i * N; }
+
+    friend constexpr StaticMat operator*(const StaticMat& x, const StaticMat& y) {
+        StaticMat r;
+#pragma GCC unroll 8
+        for (int i = 0; i < N; i++)
+#pragma GCC unroll 8
+            for (int j = 0; j < N; j++) {
+                Mint s = 0;
+#pragma GCC unroll 8
+                for (int k = 0; k < N; k++) s += x.a[i * N + k] * y.a[k * N + j];
+                r.a[i * N + j] = s;
+            }
+        return r;
+    }
+    constexpr StaticMat& operator*=(const StaticMat& o) { return *this = *this * o; }
+
+    constexpr StaticMat pow(long long e) const {
+        StaticMat base = *this, res = identity();
+        while (e > 0) {
+            if (e & 1) res = res * base;
+            e >>= 1;
+            if (e) base = base * base;
+        }
+        return res;
+    }
+
+    constexpr array<Mint, N> mulVec(const array<Mint, N>& v) const {
+        array<Mint, N> res{};
+#pragma GCC unroll 8
+        for (int i = 0; i < N; i++) {
+            Mint s = 0;
+#pragma GCC unroll 8
+            for (int j = 0; j < N; j++) s += a[i * N + j] * v[j];
+            res[i] = s;
+        }
+        return res;
+    }
+};
+
+// Nửa vành (semiring) cho SemiMat: zero() = phần tử "không có đường", one() = đơn vị của mul.
+// row_update(Ci, x, Bk, n): Ci[j] = add(Ci[j], mul(x, Bk[j])) — viết không rẽ nhánh để vector hoá;
+// fix(v) chuẩn hoá giá trị "vô cực" bị lệch sau khi cộng (INF + w).
+// Yêu cầu: mọi giá trị hữu hạn có |v| < INF/2 với INF = max/4 (không tràn khi cộng hai INF).
+template<class T>
+struct MinPlus {
+    static constexpr T INF = numeric_limits<T>::max() / 4;
+    static constexpr T zero() { return INF; }
+    static constexpr T one() { return 0; }
+    static T add(T x, T y) { return min(x, y); }
+    static T mul(T x, T y) { return (x == INF || y == INF) ? INF : x + y; }
+    static void row_update(T* Ci, T x, const T* Bk, int n) {
+        for (int j = 0; j < n; j++) Ci[j] = min(Ci[j], x + Bk[j]);
+    }
+    static T fix(T v) { return v >= INF / 2 ? INF : v; }
+};
+
+template<class T>
+struct MaxPlus {
+    static constexpr T INF = numeric_limits<T>::max() / 4;
+    static constexpr T zero() { return -INF; }
+    static constexpr T one() { return 0; }
+    static T add(T x, T y) { return max(x, y); }
+    static T mul(T x, T y) { return (x == -INF || y == -INF) ? -INF : x + y; }
+    static void row_update(T* Ci, T x, const T* Bk, int n) {
+        for (int j = 0; j < n; j++) Ci[j] = max(Ci[j], x + Bk[j]);
+    }
+    static T fix(T v) { return v <= -INF / 2 ? -INF : v; }
+};
+
+// Ma trận trên nửa vành S (MinPlus/MaxPlus<T>): cùng giao diện Mat, phép nhân (add, mul) của S.
+// Nửa vành mod dùng Mat<Mint> (kernel riêng ở trên), boolean dùng BoolMat (bit-packed).
+template<class S>
+struct SemiMat {
+    using T = decltype(S::one());
+
+    int n;
+    vector<T> a; // row-major phẳng
+
+    SemiMat(int n = 0, bool ident = false) : n(n), a((size_t)n * n, S::zero()) {
+        if (ident)
+            for (int i = 0; i < n; i++) a[(size_t)i * n + i] = S::one();
+    }
+
+    static SemiMat identity(int n) { return SemiMat(n, true); }
+
+    T* operator[](int i) { return a.data() + (size_t)i * n; }
+    const T* operator[](int i) const { return a.data() + (size_t)i * n; }
+
+    SemiMat& operator*=(const SemiMat& o) {
+        assert(n == o.n);
+        SemiMat r(n);
+        for (int i = 0; i < n; i++) {
+            const T* Ai = (*this)[i];
+            T* Ri = r[i];
+            for (int k = 0; k < n; k++) {
+                if (Ai[k] == S::zero()) continue;
+                S::row_update(Ri, Ai[k], o[k], n);
+            }
+            for (int j = 0; j < n; j++) Ri[j] = S::fix(Ri[j]);
+        }
+        return (*this = move(r));
+    }
+
+    friend SemiMat operator*(SemiMat l, const SemiMat& r) { l *= r; return l; }
+
+    SemiMat pow(long long e) const {
+        SemiMat base = *this, res = identity(n);
+        while (e > 0) {
+            if (e & 1) res = res * base;
+            e >>= 1;
+            if (e) base = base * base;
+        }
+        return res;
+    }
+
+    vector<T> mulVec(const vector<T>& v) const {
+        assert((int)v.size() == n);
+        vector<T> res(n, S::zero());
+        for (int i = 0; i < n; i++) {
+            const T* Ai = (*this)[i];
+            for (int j = 0; j < n; j++) res[i] = S::add(res[i], S::mul(Ai[j], v[j]));
+        }
+        return res;
+    }
+};
+
+// Ma trận boolean (OR, AND) nén 64 phần tử / u64: hàng i là W = ceil(n/64) từ.
+// Nhân: C[i] |= B[k] với mọi bit k bật trong A[i] — O(n^2 * n/64).
+struct BoolMat {
+    int n, W;
+    vector<uint64_t> a; // hàng i: a[i*W .. i*W + W)
+
+    BoolMat(int n = 0, bool ident = false) : n(n), W((n + 63) >> 6), a((size_t)n * W, 0) {
+        if (ident)
+            for (int i = 0; i < n; i++) set(i, i);
+    }
+
+    static BoolMat identity(int n) { return BoolMat(n, true); }
+
+    bool get(int i, int j) const { return a[(size_t)i * W + (j >> 6)] >> (j & 63) & 1; }
+    void set(int i, int j, bool v = true) {
+        uint64_t& w = a[(size_t)i * W + (j >> 6)];
+        if (v) w |= 1ULL << (j & 63); else w &= ~(1ULL << (j & 63));
+    }
+    uint64_t* row(int i) { return a.data() + (size_t)i * W; }
+    const uint64_t* row(int i) const { return a.data() + (size_t)i * W; }
+
+    BoolMat& operator*=(const BoolMat& o) {
+        assert(n == o.n);
+        BoolMat r(n);
+        for (int i = 0; i < n; i++) {
+            const uint64_t* Ai = row(i);
+            uint64_t* Ri = r.row(i);
+            for (int w = 0; w < W; w++)
+                for (uint64_t bits = Ai[w]; bits; bits &= bits - 1) {
+                    const uint64_t* Bk = o.row((w << 6) | __builtin_ctzll(bits));
+                    for (int t = 0; t < W; t++) Ri[t] |= Bk[t];
+                }
+        }
+        return (*this = move(r));
+    }
+
+    friend BoolMat operator*(BoolMat l, const BoolMat& r) { l *= r; return l; }
+
+    BoolMat pow(long long e) const {
+        BoolMat base = *this, res = identity(n);
+        while (e > 0) {
+            if (e & 1) res = res * base;
+            e >>= 1;
+            if (e) base = base * base;
+        }
+        return res;
+    }
+
+    // v nén bit như một hàng (W từ); trả về res[i] = OR_j (A[i][j] AND v[j])
+    vector<uint64_t> mulVec(const vector<uint64_t>& v) const {
+        assert((int)v.size() == W);
+        vector<uint64_t> res(W, 0);
+        for (int i = 0; i < n; i++) {
+            const uint64_t* Ai = row(i);
+            uint64_t any = 0;
+            for (int t = 0; t < W; t++) any |= Ai[t] & v[t];
+            if (any) res[i >> 6] |= 1ULL << (i & 63);
+        }
+        return res;
+    }
+};
+
+// Ma trận thưa dạng CSR: hàng i gồm các cặp (col[t], val[t]) với t in [start[i], start[i+1]).
+// Bộ nhớ O(n + nnz) thay vì O(n^2); dùng cho ma trận kề của đồ thị thưa.
+template<class Mint>
+struct SparseMat {
+    using u64 = unsigned long long;
+
+    int n;
+    vector<int> start, col;
+    vector<Mint> val;
+
+    // entries: (i, j, x); các cặp (i, j) trùng được cộng dồn (vd đa cạnh)
+    SparseMat(int n, vector<tuple<int, int, Mint>> entries) : n(n), start(n + 1, 0) {
+        sort(entries.begin(), entries.end(), [](const auto& x, const auto& y) {
+            return make_pair(get<0>(x), get<1>(x)) < make_pair(get<0>(y), get<1>(y));
+        });
+        int last = -1;
+        for (auto& [i, j, x] : entries) {
+            assert(0 <= i && i < n && 0 <= j && j < n);
+            if (i == last && col.back() == j) { val.back() += x; continue; }
+            col.push_back(j); val.push_back(x);
+            start[i + 1]++; last = i;
+        }
+        for (int i = 0; i < n; i++) start[i + 1] += start[i];
+    }
+
+    static SparseMat from_dense(const Mat<Mint>& A) {
+        vector<tuple<int, int, Mint>> e;
+        for (int i = 0; i < A.n; i++)
+            for (int j = 0; j < A.n; j++)
+                if (A[i][j] != Mint(0)) e.emplace_back(i, j, A[i][j]);
+        return SparseMat(A.n, move(e));
+    }
+
+    int nnz() const { return (int)col.size(); }
+
+    // A * v, O(nnz)
+    vector<Mint> mulVec(const vector<Mint>& v) const {
+        assert((int)v.size() == n);
+        const int lazy = Mint::lazy_terms();
+        vector<Mint> res(n);
+        for (int i = 0; i < n; i++) {
+            for (int t0 = start[i]; t0 < start[i + 1]; t0 += lazy) {
+                int t1 = min(start[i + 1], t0 + lazy);
+                u64 sum = 0;
+                for (int t = t0; t < t1; t++) sum += (u64)val[t].rep() * v[col[t]].rep();
+                res[i] += Mint::from_sum(sum);
+            }
+        }
+        return res;
+    }
+
+    // A * B (B dày), O(nnz * n): hàng i của kết quả = Σ val * (hàng col của B)
+    Mat<Mint> operator*(const Mat<Mint>& B) const {
+        assert(n == B.n);
+        const int lazy = Mint::lazy_terms();
+        Mat<Mint> R(n);
+        vector<u64> acc(n);
+        for (int i = 0; i < n; i++) {
+            Mint* Ri = R[i];
+            for (int t0 = start[i]; t0 < start[i + 1]; t0 += lazy) {
+                int t1 = min(start[i + 1], t0 + lazy);
+                fill(acc.begin(), acc.end(), 0);
+                for (int t = t0; t < t1; t++) {
+                    u64 x = val[t].rep();
+                    const uint32_t* Bk = B.rep_row(col[t]);
+                    for (int j = 0; j < n; j++) acc[j] += x * Bk[j];
+                }
+                for (int j = 0; j < n; j++) Ri[j] += Mint::from_sum(acc[j]);
+            }
+        }
+        return R;
+    }
+
+    // A^k * v không tạo ma trận dày (bình phương ma trận thưa sẽ lấp đầy thành dày).
+    // - k <= 2n: nhân vector k lần, O(k * nnz).
+    // - k lớn: đa thức tối tiểu p của A theo v bằng Berlekamp–Massey trên dãy r·A^i v
+    //   (r ngẫu nhiên, cần MOD nguyên tố, sai với xác suất ~ n/MOD), rồi
+    //   A^k v = Σ q_j A^j v với q = x^k mod p. O(n * nnz + n^2 log k), bộ nhớ O(n + nnz).
+    vector<Mint> powVec(unsigned long long k, vector<Mint> v) const {
+        assert((int)v.size() == n);
+        if (k <= 2ULL * n) {
+            while (k--) v = mulVec(v);
+            return v;
+        }
+        mt19937_64 rng(chrono::steady_clock::now().time_since_epoch().count());
+        vector<Mint> r(n);
+        for (auto& x : r) x = (long long)(rng() >> 2);
+        vector<Mint> seq(2 * n), cur = v;
+        for (int i = 0; i < 2 * n; i++) {
+            Mint s = 0;
+            for (int j = 0; j < n; j++) s += r[j] * cur[j];
+            seq[i] = s;
+            cur = mulVec(cur);
+        }
+        vector<Mint> c = berlekamp_massey(seq);
+        int L = (int)c.size();
+        if (L == 0) return vector<Mint>(n);
+        // q = x^k mod p(x), p(x) = x^L - Σ c_j x^{L-j}
+        auto mulmod = [&](const vector<Mint>& x, const vector<Mint>& y) {
+            vector<Mint> z = poly_mul(x, y);
+            for (int d = (int)z.size() - 1; d >= L; d--) {
+                if (z[d] == Mint(0)) continue;
+                for (int j = 1; j <= L; j++) z[d - j] += z[d] * c[j - 1];
+            }
+            z.resize(L);
+            return z;
+        };
+        vector<Mint> q(L), base(L);
+        q[0] = 1;
+        if (L == 1) base[0] = c[0]; else base[1] = 1;
+        for (; k; k >>= 1, base = mulmod(base, base))
+            if (k & 1) q = mulmod(q, base);
+        vector<Mint> res(n);
+        cur = v;
+        for (int j = 0; j < L; j++) {
+            if (q[j] != Mint(0))
+                for (int i = 0; i < n; i++) res[i] += q[j] * cur[i];
+            if (j + 1 < L) cur = mulVec(cur);
         }
         return res;
     }
@@ -78,29 +712,68 @@ MỤC ĐÍCH
 - Dùng cho truy hồi tuyến tính, đếm đường đi độ dài k, chuyển trạng thái k bước…
 
 API
+- Mat<Mint>: Mint là kiểu modint trong modint.cpp
+    using M = Mat<mint107>;              // MOD = 1e9+7 cố định (Montgomery)
+    using M = Mat<dmint>; dmint::set_mod(p); // MOD đọc lúc chạy (Barrett)
 - Mat(n, ident=false): tạo ma trận n x n (0-index), tuỳ chọn đơn vị.
+- M[i][j]: truy cập phần tử; dữ liệu lưu phẳng row-major trong M.a (a[i*n + j]).
 - Mat::identity(n): ma trận đơn vị.
 - operator* / operator*= : nhân ma trận (modulo), O(n^3).
 - pow(e): lũy thừa ma trận A^e, O(n^3 log e).
-- mulVec(v): nhân ma trận với vector kích thước n, trả về vector mới.
+- mulVec(v): nhân ma trận với vector<Mint> kích thước n, trả về vector mới.
+- mat_rank(A), mat_det(A), mat_inverse(A, inv) -> bool, mat_solve(A, b, x) -> bool: khử
+    Gauss–Jordan O(n^3) trên bộ nhớ phẳng (MOD nguyên tố). gauss_jordan(a, rows, cols, var_cols)
+    dùng trực tiếp cho ma trận chữ nhật / nhiều vế phải.
+    Khử theo panel lazy_terms() cột, phần còn lại cập nhật bằng cùng kernel u64/AVX2 của phép nhân
+    (nghịch đảo 800x800 mod 1e9+7: ~0.4 s so với ~2 s khi trừ hàng từng phần tử).
+- XorSystem(rows, cols): hệ XOR trên GF(2) nén bit; set(i, j), set_rhs(i, b), eliminate() = hạng,
+    solve(x) -> bool. O(rows * cols^2 / 64).
+- MatPowTable<Mint>(T, max_e, LOG_B=1): tiền xử lý T^(d * 2^(LOG_B*i)); apply(e, v) = T^e * v
+    chỉ bằng mulVec, O(n^2 log e) mỗi truy vấn thay vì O(n^3 log e) của T.pow(e).
+- StaticMat<N, Mint>: như Mat nhưng kích thước N cố định, lưu trong std::array
+    (không cấp phát), mọi hàm constexpr; identity() không tham số, mulVec nhận array<Mint, N>.
+- SemiMat<MinPlus<long long>> / SemiMat<MaxPlus<long long>>: cùng giao diện Mat trên nửa vành
+    (min,+) / (max,+); "không có cạnh" = S::zero() (= ±INF, INF = max/4), đường chéo đơn vị = 0.
+    A.pow(k)[u][v] = đường đi ngắn nhất / dài nhất dùng đúng k cạnh.
+- BoolMat(n): ma trận boolean nén bit (64 phần tử / u64); get/set(i, j), pow(k)[u][v] = có
+    đường đi độ dài đúng k; nhân O(n^3 / 64).
+- SparseMat<Mint>(n, {(i, j, x)...}): ma trận thưa CSR, bộ nhớ O(n + nnz).
+    S.mulVec(v) O(nnz); S * B (B dày) O(nnz * n); S.powVec(k, v) = S^k v.
 
 CÁCH DÙNG NHANH
 - Fibonacci n:
-    Mat T(2);
-    T.a[0][0] = 1; T.a[0][1] = 1;
-    T.a[1][0] = 1; T.a[1][1] = 0;
-    Mat P = T.pow(n); // P = T^n
+    Mat<mint107> T(2);
+    T[0][0] = 1; T[0][1] = 1;
+    T[1][0] = 1; T[1][1] = 0;
+    auto P = T.pow(n); // P = T^n
     // Nếu vector cột ban đầu x0 = [F1, F0]^T, thì x_n = P * x0, F_n = x_n[1].
+    // Chỉ cần một số hạng của truy hồi bậc k: linear_rec_nth (linear_recurrence.cpp)
+    // chạy O(k^2 log n) thay vì O(k^3 log n), và tự tìm truy hồi bằng Berlekamp–Massey.
 
 - Số đường đi độ dài k trên đồ thị n đỉnh:
-    Mat A(n);
+    Mat<mint107> A(n);
     // A[u][v] = số cung u->v (thường 0/1)
-    Mat Ak = A.pow(k); // Ak[u][v] = số đường đi độ dài k từ u đến v
+    auto Ak = A.pow(k); // Ak[u][v] = số đường đi độ dài k từ u đến v
+
+- Đồ thị thưa (n lớn, m cạnh): không tạo ma trận dày
+    vector<tuple<int,int,mint107>> e; // (u, v, 1) cho mỗi cung u->v
+    SparseMat<mint107> S(n, e);
+    vector<mint107> x(n); x[t] = 1;
+    auto y = S.powVec(k, x);            // y[u] = số đường đi độ dài k từ u tới t
 
 GỢI Ý TỐI ƯU
-- Đổi MOD tuỳ bài (1e9+7, 998244353, ...).
-- Nếu MOD lớn và tích có thể vượt 1e18, cân nhắc dùng __int128 khi nhân.
-- Với kích thước nhỏ cố định, có thể dùng std::array<array<long long,N>,N> để nhanh hơn.
+- Đổi MOD bằng kiểu Mint (mint107, mint998, dmint...), không cần sửa Mat.
+- Phép nhân cộng dồn tích rep vào u64 và chỉ rút gọn (Montgomery/Barrett, không có
+  phép chia 64-bit) sau mỗi Mint::lazy_terms() số hạng (18 với 1e9+7).
+- Lưu phẳng + chia tile (k theo lazy_terms(), j theo TILE_J) giữ khối B đang dùng trong L1;
+  với n cỡ 300–600 đây là phần chi phối thời gian.
+- Kernel AVX2 (_mm256_mul_epu32, 16 cột/lượt) được chọn lúc chạy nếu CPU hỗ trợ;
+  Mat<Mint>::use_simd = false để ép bản scalar (so sánh / máy không có AVX2).
+- Ma trận lớn (n >= 128): đặt Mat<Mint>::threads = số nhân; mỗi phép nhân (kể cả
+  trong pow) chia hàng của kết quả cho các luồng, pow tăng tốc gần tuyến tính theo số nhân.
+- Với kích thước nhỏ cố định (2x2, 3x3 trong vòng lặp nóng) dùng StaticMat<N, Mint>:
+    constexpr StaticMat<2, mint107> F = [] { StaticMat<2, mint107> t; t[0][0] = t[0][1] = t[1][0] = 1; return t; }();
+    constexpr auto F10 = F.pow(10);   // tính lúc biên dịch, F10[0][1] = 55
 
 ĐỘ PHỨC TẠP
 - Nhân: O(n^3)
@@ -108,3 +781,22 @@ GỢI Ý TỐI ƯU
 ================================================================================
 */
 
+/* ---------------- Benchmark (scalar vs AVX2) ------------------
+int main(){
+    mt19937 rng(1);
+    for (int n = 64; n <= 1024; n *= 2) {
+        Mat<mint107> A(n), B(n);
+        for (auto& x : A.a) x = rng();
+        for (auto& x : B.a) x = rng();
+        double t[2];
+        for (int simd = 0; simd < 2; simd++) {
+            Mat<mint107>::use_simd = simd;
+            int reps = max(1, (1 << 27) / n / n / n);
+            auto st = chrono::steady_clock::now();
+            for (int r = 0; r < reps; r++) { auto C = A * B; (void)C; }
+            t[simd] = chrono::duration<double, milli>(chrono::steady_clock::now() - st).count() / reps;
+        }
+        printf("n=%4d  scalar %9.2f ms  avx2 %9.2f ms  x%.2f\n", n, t[0], t[1], t[0] / t[1]);
+    }
+}
+------------------------------------------------*/
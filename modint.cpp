@@ -0,0 +1,199 @@
+/**
+ * @file modint.cpp
+ * @brief Số nguyên modulo không dùng phép chia 64-bit trong vòng lặp nóng
+ *
+ * Nội dung
+ * - MontgomeryModint<MOD>: MOD lẻ biết lúc biên dịch (1e9+7, 998244353, ...), nhân = 2 phép nhân + dịch bit.
+ * - Barrett + DynamicModint<id>: MOD chỉ biết lúc chạy (đọc từ input), đổi bằng set_mod() không cần biên dịch lại.
+ *
+ * Giao diện chung (để Mat<Mint> và các template khác dùng được cả hai loại)
+ * - Mint(x), +, -, *, /, pow(e), inv(), val() (giá trị thật trong [0, MOD)), mod().
+ * - rep(): biểu diễn bên trong (Montgomery: x*2^32 mod MOD; Barrett: chính x).
+ * - from_sum(s): với s = tổng các rep(a_i)*rep(b_i) (s < 2^64) trả về Mint bằng tổng a_i*b_i.
+ * - lazy_terms(): số tích rep*rep cộng dồn được vào một u64 trước khi phải gọi from_sum.
+ *   => vòng lặp nóng chỉ cộng u64, phép rút gọn trễ lại mỗi lazy_terms() số hạng.
+ *
+ * Quy ước
+ * - MOD < 2^31 (Montgomery còn phải lẻ) để phép cộng hai số < MOD không tràn u32.
+ */
+
+#pragma once
+#include <bits/stdc++.h>
+using namespace std;
+
+/* ========================================================================
+ * 1) MontgomeryModint<MOD> — MOD lẻ, cố định lúc biên dịch
+ *    R = 2^32, lưu v = x*R mod MOD trong [0, MOD).
+ * ====================================================================== */
+template<uint32_t MOD>
+struct MontgomeryModint {
+    using u32 = uint32_t;
+    using u64 = uint64_t;
+    static_assert(MOD & 1, "Montgomery cần MOD lẻ");
+    static_assert(MOD < (1u << 31), "Montgomery cần MOD < 2^31");
+
+    // NEG_INV * MOD ≡ -1 (mod 2^32); R1 = R mod MOD; R2 = R^2 mod MOD
+    static constexpr u32 calc_neg_inv() {
+        u32 inv = MOD;
+        for (int i = 0; i < 4; i++) inv *= 2u - MOD * inv;
+        return -inv;
+    }
+    static constexpr u32 NEG_INV = calc_neg_inv();
+    static constexpr u32 R1 = (u32)((1ULL << 32) % MOD);
+    static constexpr u32 R2 = (u32)(-(u64)MOD % MOD);
+
+    u32 v = 0;
+
+    // x < MOD * 2^32  ->  x * R^-1 mod MOD
+    static constexpr u32 reduce(u64 x) {
+        u32 q = (u32)x * NEG_INV;
+        u32 t = (u32)((x + (u64)q * MOD) >> 32);
+        return t >= MOD ? t - MOD : t;
+    }
+
+    constexpr MontgomeryModint() {}
+    constexpr MontgomeryModint(long long x)
+        : v(reduce((u64)(x % (long long)MOD + (x < 0 ? (long long)MOD : 0)) * R2)) {}
+
+    static constexpr u32 mod() { return MOD; }
+    constexpr u32 val() const { return reduce(v); }
+    constexpr u32 rep() const { return v; }
+    static constexpr MontgomeryModint from_rep(u32 r) { MontgomeryModint m; m.v = r; return m; }
+
+    // s = Σ rep*rep = Σ a*b*R^2; tách s = hi*2^32 + lo: s*R^-1 = reduce(lo) + hi (hi mod MOD = reduce(hi*R1))
+    static constexpr MontgomeryModint from_sum(u64 s) {
+        u32 t = reduce((u32)s) + reduce((s >> 32) * R1);
+        return from_rep(t >= MOD ? t - MOD : t);
+    }
+    static constexpr int lazy_terms() {
+        return (int)min<u64>(1 << 20, ~0ULL / ((u64)(MOD - 1) * (MOD - 1) + 1));
+    }
+
+    constexpr MontgomeryModint& operator+=(const MontgomeryModint& o) {
+        v += o.v; if (v >= MOD) v -= MOD; return *this;
+    }
+    constexpr MontgomeryModint& operator-=(const MontgomeryModint& o) {
+        v = v >= o.v ? v - o.v : v + MOD - o.v; return *this;
+    }
+    constexpr MontgomeryModint& operator*=(const MontgomeryModint& o) {
+        v = reduce((u64)v * o.v); return *this;
+    }
+    constexpr MontgomeryModint& operator/=(const MontgomeryModint& o) { return *this *= o.inv(); }
+    constexpr MontgomeryModint operator-() const { return MontgomeryModint() - *this; }
+
+    friend constexpr MontgomeryModint operator+(MontgomeryModint a, const MontgomeryModint& b) { return a += b; }
+    friend constexpr MontgomeryModint operator-(MontgomeryModint a, const MontgomeryModint& b) { return a -= b; }
+    friend constexpr MontgomeryModint operator*(MontgomeryModint a, const MontgomeryModint& b) { return a *= b; }
+    friend constexpr MontgomeryModint operator/(MontgomeryModint a, const MontgomeryModint& b) { return a /= b; }
+    friend constexpr bool operator==(const MontgomeryModint& a, const MontgomeryModint& b) { return a.v == b.v; }
+    friend constexpr bool operator!=(const MontgomeryModint& a, const MontgomeryModint& b) { return a.v != b.v; }
+
+    constexpr MontgomeryModint pow(unsigned long long e) const {
+        MontgomeryModint r = 1, b = *this;
+        for (; e; e >>= 1, b *= b) if (e & 1) r *= b;
+        return r;
+    }
+    constexpr MontgomeryModint inv() const { return pow(MOD - 2); } // MOD nguyên tố
+
+    friend ostream& operator<<(ostream& os, const MontgomeryModint& m) { return os << m.val(); }
+};
+
+/* ========================================================================
+ * 2) Barrett — x mod m cho x < 2^64, 1 <= m < 2^32 chỉ bằng nhân (m đặt lúc chạy)
+ *    im = floor((2^64-1)/m)  =>  q = floor(x*im / 2^64) lệch floor(x/m) tối đa 2.
+ * ====================================================================== */
+struct Barrett {
+    uint32_t m = 1;
+    uint64_t im = ~0ULL;
+
+    Barrett() {}
+    explicit Barrett(uint32_t m) : m(m), im(~0ULL / m) {}
+
+    uint32_t reduce(uint64_t x) const {
+        uint64_t q = (uint64_t)(((unsigned __int128)x * im) >> 64);
+        uint64_t r = x - q * m;
+        if (r >= m) r -= m;
+        if (r >= m) r -= m;
+        return (uint32_t)r;
+    }
+};
+
+/* ========================================================================
+ * 3) DynamicModint<id> — MOD đặt lúc chạy qua set_mod(m)
+ *    id phân biệt các modulus dùng đồng thời (vd DynamicModint<0>, <1>).
+ * ====================================================================== */
+template<int id>
+struct DynamicModint {
+    using u32 = uint32_t;
+    using u64 = uint64_t;
+
+    static inline Barrett bt{998244353};
+
+    u32 v = 0;
+
+    static void set_mod(u32 m) { assert(1 <= m && m < (1u << 31)); bt = Barrett(m); }
+    static u32 mod() { return bt.m; }
+
+    DynamicModint() {}
+    DynamicModint(long long x) {
+        long long r = x % (long long)mod();
+        v = (u32)(r < 0 ? r + mod() : r);
+    }
+
+    u32 val() const { return v; }
+    u32 rep() const { return v; }
+    static DynamicModint from_rep(u32 r) { DynamicModint m; m.v = r; return m; }
+    static DynamicModint from_sum(u64 s) { return from_rep(bt.reduce(s)); }
+    static int lazy_terms() {
+        u64 m1 = mod() - 1;
+        return (int)min<u64>(1 << 20, ~0ULL / (m1 * m1 + 1));
+    }
+
+    DynamicModint& operator+=(const DynamicModint& o) { v += o.v; if (v >= mod()) v -= mod(); return *this; }
+    DynamicModint& operator-=(const DynamicModint& o) { v = v >= o.v ? v - o.v : v + mod() - o.v; return *this; }
+    DynamicModint& operator*=(const DynamicModint& o) { v = bt.reduce((u64)v * o.v); return *this; }
+    DynamicModint& operator/=(const DynamicModint& o) { return *this *= o.inv(); }
+    DynamicModint operator-() const { return DynamicModint() - *this; }
+
+    friend DynamicModint operator+(DynamicModint a, const DynamicModint& b) { return a += b; }
+    friend DynamicModint operator-(DynamicModint a, const DynamicModint& b) { return a -= b; }
+    friend DynamicModint operator*(DynamicModint a, const DynamicModint& b) { return a *= b; }
+    friend DynamicModint operator/(DynamicModint a, const DynamicModint& b) { return a /= b; }
+    friend bool operator==(const DynamicModint& a, const DynamicModint& b) { return a.v == b.v; }
+    friend bool operator!=(const DynamicModint& a, const DynamicModint& b) { return a.v != b.v; }
+
+    DynamicModint pow(unsigned long long e) const {
+        DynamicModint r = 1, b = *this;
+        for (; e; e >>= 1, b *= b) if (e & 1) r *= b;
+        return r;
+    }
+    // Euclid mở rộng: đúng cả khi MOD không nguyên tố (miễn gcd(v, MOD) = 1)
+    DynamicModint inv() const {
+        long long a = v, b = mod(), x = 1, y = 0;
+        while (b) { long long t = a / b; a -= t * b; swap(a, b); x -= t * y; swap(x, y); }
+        assert(a == 1);
+        return DynamicModint(x);
+    }
+
+    friend ostream& operator<<(ostream& os, const DynamicModint& m) { return os << m.val(); }
+};
+
+using mint107 = MontgomeryModint<1000000007>;
+using mint998 = MontgomeryModint<998244353>;
+using dmint = DynamicModint<-1>;
+
+/* ---------------- Ví dụ sử dụng ------------------
+int main(){
+    mint998 a = 3, b = 5;
+    cout << a * b.inv() << "\n";          // 3/5 mod 998244353
+
+    dmint::set_mod(1000000007);           // MOD đọc từ input
+    dmint c = 123456789;
+    cout << c.pow(1000000) << "\n";
+
+    // Rút gọn trễ: cộng dồn tích rep (tối đa lazy_terms() số hạng) rồi rút gọn một lần
+    uint64_t s = 0;
+    for (int i = 0; i < 10; i++) s += (uint64_t)a.rep() * b.rep();
+    cout << (mint998::from_sum(s) == a * b * 10) << "\n"; // 1
+}
+------------------------------------------------*/
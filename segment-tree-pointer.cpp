@@ -6,7 +6,9 @@
  * - Cây đoạn dùng con trỏ, cấp phát node theo nhu cầu (sparse), phù hợp khi miền chỉ số rất lớn
  *   (ví dụ tới 1e18) nhưng số thao tác cập nhật/truy vấn tương đối ít.
  * - Dễ tuỳ chỉnh phép gộp (sum/min/max/…): thay `ID` (đơn vị) và hàm `op(a,b)`.
- * - Kèm biến thể lazy phổ biến: cộng trên đoạn và truy vấn tổng (range add + range sum).
+ * - Kèm bản lazy tổng quát (range apply + range query) và bản cộng đoạn/tổng đoạn thường dùng.
+ * - Node nằm trong NodePool (vector liền mạch, con là chỉ số 32-bit): không gọi `new` cho từng node,
+ *   node nhỏ hơn (ll: 24 -> 16 byte), xoá cả cây O(1) bằng clear() để dùng lại giữa các test.
  *
  * Khi nào dùng
  * - Dùng: miền chỉ số dài, không thể/cần thiết cấp phát mảng 4*N; chỉ có một phần nhỏ các điểm/đoạn được chạm tới.
@@ -15,7 +17,8 @@
  * Quy ước
  * - Chỉ số 0-based. Đoạn chuẩn dạng nửa mở [l, r).
  * - Luôn đảm bảo L < R trong khởi tạo. Mid tính an toàn: l + (r-l)/2.
- * - Node null biểu thị node rỗng với giá trị `ID`.
+ * - Chỉ số 0 là node null (node rỗng với giá trị `ID`), không bao giờ bị ghi.
+ * - Tối đa ~4e9 node (chỉ số u32); mỗi lần set_point tạo tối đa ~log2(R-L) node.
  *
  * Tuỳ chỉnh nhanh (monoid):
  * - Tổng:    `ID = 0`,      `op = [](T a,T b){return a+b;}`
@@ -24,42 +27,99 @@
  * - XOR:     `ID = 0`,      `op = [](T a,T b){return a^b;}`
  *
  * Biến thể kèm theo
- * - DynLazySegTreeAddSum: hỗ trợ cộng trên đoạn và truy vấn tổng.
- *   Có thể mở rộng sang các lazy khác (assign, chmax/chmin…) nhưng phức tạp hơn, cần định nghĩa rõ `apply/compose`.
+ * - DynLazySegTree<Monoid, Action>: lazy tổng quát (add/assign/affine/… + sum/min/max/…),
+ *   kèm max_right/min_left (tìm kiếm nhị phân trên cây).
+ * - DynLazySegTreeAddSum: cộng trên đoạn và truy vấn tổng (bọc DynLazySegTree).
+ * - ConcurrentDynSegTree: như DynSegTreeMonoid, một thread ghi + nhiều thread đọc không khoá.
  */
 
 #pragma once
 #include <bits/stdc++.h>
 using namespace std;
 
+/* ========================================================================
+ * 0) NodePool — kho node dùng chung cho các cây bên dưới
+ *    - a[0] là node null (giữ giá trị đơn vị), node thật có chỉ số >= 1.
+ *    - alloc() lấy từ danh sách tự do (`freed`) trước, hết thì push_back; tham chiếu pool[i]
+ *      mất hiệu lực khi vector giãn, nên code gọi alloc() giữa chừng phải đọc lại pool[i] sau đó.
+ *    - release(i): trả node về danh sách tự do (vd sau gc/merge), chỉ số không đổi => root cũ vẫn hợp lệ.
+ *    - clear(): xoá mọi node (giữ capacity); reserve(n) nếu biết trước số node.
+ * ====================================================================== */
+template<class Node>
+struct NodePool {
+    vector<Node> a;
+    vector<uint32_t> freed;
+
+    explicit NodePool(const Node& nil = Node()) { a.push_back(nil); }
+
+    uint32_t alloc(const Node& x) {
+        if(!freed.empty()){ uint32_t i = freed.back(); freed.pop_back(); a[i] = x; return i; }
+        assert(a.size() < UINT32_MAX);
+        a.push_back(x);
+        return (uint32_t)a.size() - 1;
+    }
+    void release(uint32_t i) { if(i) freed.push_back(i); }
+    Node& operator[](uint32_t i) { return a[i]; }
+    const Node& operator[](uint32_t i) const { return a[i]; }
+
+    void clear() { a.resize(1); freed.clear(); }
+    void reserve(size_t n) { a.reserve(n + 1); }
+    size_t size() const { return a.size() - 1 - freed.size(); } // số node thật đang dùng
+};
+
 /* ========================================================================
  * 1) DynSegTreeMonoid — point set + rectangle query (monoid op)
  *    - Tuỳ chỉnh bằng ID (đơn vị) và op(a,b)
  *    - Dùng cho: set/overwrite giá trị tại 1 điểm, truy vấn gộp trên [ql, qr)
+ *    - Persistent (nhiều phiên bản): các hàm nhận `rt` không sửa node cũ mà sao chép đường đi
+ *      (~log2(R-L) node mới/lần), trả về root mới; root cũ vẫn truy vấn được.
+ *      gc(roots) thu hồi node không còn đến được từ các root giữ lại (và `root`).
+ *      Không trộn set_point(p, v)/set_points (sửa tại chỗ) lên node dùng chung với phiên bản khác.
+ *    - Merge/split (nhiều cây trong cùng một pool, mỗi cây là một root):
+ *      merge(a, b) gộp b vào a (lá trùng: op), node thừa của b trả về pool; tổng chi phí mọi lần
+ *      merge O(tổng số node đã tạo). split(rt, k) tách [L, k) | [k, R), tạo O(log U) node.
+ *      Cả hai sửa tại chỗ: không dùng lên root đang được giữ làm phiên bản persistent.
  * ====================================================================== */
 template<class T, class Op>
 struct DynSegTreeMonoid {
     struct Node {
-        T val; Node *l=nullptr, *r=nullptr;
-        explicit Node(const T& v): val(v) {}
+        T val; uint32_t l=0, r=0;
     };
 
     long long L, R;   // miền gốc [L, R)
     T ID;             // phần tử đơn vị
     Op op;            // phép gộp
-    Node* root = nullptr;
+    NodePool<Node> pool;
+    uint32_t root = 0;
 
     DynSegTreeMonoid(long long L, long long R, T id, Op op)
-        : L(L), R(R), ID(id), op(op) { assert(L < R); }
+        : L(L), R(R), ID(id), op(op), pool(Node{id}) { assert(L < R); }
 
-    // Lấy giá trị node (kể cả null) — null tương đương ID
-    inline T value(Node* n) const { return n ? n->val : ID; }
+    // Lấy giá trị node (kể cả null) — pool[0].val = ID nên không cần rẽ nhánh
+    inline const T& value(uint32_t n) const { return pool[n].val; }
 
     // Kéo giá trị từ 2 con
-    inline void pull(Node* n){ n->val = op(value(n->l), value(n->r)); }
+    inline void pull(uint32_t n){ pool[n].val = op(value(pool[n].l), value(pool[n].r)); }
+
+    // Xoá toàn bộ cây (giữ bộ nhớ đã cấp phát để dùng lại)
+    void clear(){ pool.clear(); root = 0; }
+    void reserve(size_t nodes){ pool.reserve(nodes); }
 
     // Gán điểm p = v
-    void set_point(long long p, const T& v){ set_point(root, L, R, p, v); }
+    void set_point(long long p, const T& v){ root = set_point(root, L, R, p, v); }
+
+    // Gán hàng loạt: [first, last) gồm pair(p, v) đã sắp tăng theo p (p trùng: phần tử sau thắng).
+    // Đi xuống một lần, tách lô tại mid của mỗi node => mỗi node bị chạm chỉ thăm và pull một lần.
+    // O(k log(U/k) + k) thay vì O(k log U) của k lần set_point; điểm ngoài [L, R) bị bỏ qua.
+    template<class It>
+    void set_points(It first, It last){
+        auto key_less = [](const auto& x, long long p){ return x.first < p; };
+        assert(is_sorted(first, last, [](const auto& a, const auto& b){ return a.first < b.first; }));
+        first = lower_bound(first, last, L, key_less);
+        last = lower_bound(first, last, R, key_less);
+        root = set_points(root, L, R, first, last);
+    }
+    void set_points(const vector<pair<long long, T>>& pts){ set_points(pts.begin(), pts.end()); }
 
     // Truy vấn gộp trên [ql, qr)
     T query(long long ql, long long qr) const { return query(root, L, R, ql, qr); }
@@ -67,85 +127,404 @@ struct DynSegTreeMonoid {
     // (Tuỳ chọn) Lấy lại giá trị điểm: query(p, p+1)
     T get_point(long long p) const { return query(p, p+1); }
 
+    // Persistent: phiên bản mới = rt với a[p] = v (rt = 0: cây rỗng)
+    uint32_t set_point(uint32_t rt, long long p, const T& v){ return set_point_copy(rt, L, R, p, v); }
+    T query(uint32_t rt, long long ql, long long qr) const { return query(rt, L, R, ql, qr); }
+
+    // Giữ các node đến được từ roots (và root), còn lại đưa vào danh sách tự do. Trả về số node thu hồi.
+    // O(số node trong pool); chỉ số node giữ lại không đổi.
+    size_t gc(const vector<uint32_t>& roots){
+        vector<char> keep(pool.a.size(), 0);
+        vector<uint32_t> st(roots.begin(), roots.end());
+        st.push_back(root);
+        while(!st.empty()){
+            uint32_t n = st.back(); st.pop_back();
+            if(!n || keep[n]) continue;
+            keep[n] = 1;
+            st.push_back(pool[n].l); st.push_back(pool[n].r);
+        }
+        size_t before = pool.freed.size();
+        pool.freed.clear();
+        for(uint32_t i = (uint32_t)pool.a.size() - 1; i >= 1; --i) if(!keep[i]) pool.freed.push_back(i);
+        return pool.freed.size() - before;
+    }
+
+    // Gộp cây b vào cây a (cùng pool); trả về root kết quả, b không còn dùng được
+    uint32_t merge(uint32_t a, uint32_t b){ return merge(a, b, L, R); }
+    // Tách rt thành (phần [L, k), phần [k, R))
+    pair<uint32_t, uint32_t> split(uint32_t rt, long long k){ return split(rt, L, R, k); }
+
 private:
-    void ensure(Node* &n){ if(!n) n = new Node(ID); }
+    uint32_t ensure(uint32_t n){ return n ? n : pool.alloc(Node{ID}); }
+
+    // Không cấp phát => đọc pool[b] trực tiếp an toàn
+    uint32_t merge(uint32_t a, uint32_t b, long long l, long long r){
+        if(!a || !b) return a ^ b;
+        if(l + 1 == r) pool[a].val = op(pool[a].val, pool[b].val);
+        else {
+            long long m = l + ((r - l) >> 1);
+            uint32_t bl = pool[b].l, br = pool[b].r;
+            uint32_t c = merge(pool[a].l, bl, l, m); pool[a].l = c;
+            c = merge(pool[a].r, br, m, r); pool[a].r = c;
+            pull(a);
+        }
+        pool.release(b);
+        return a;
+    }
+
+    // n giữ phần [l, k), node mới t nhận phần [k, r); node rỗng sau khi tách bị thu hồi
+    pair<uint32_t, uint32_t> split(uint32_t n, long long l, long long r, long long k){
+        if(!n || r <= k) return {n, 0};
+        if(k <= l) return {0, n};
+        long long m = l + ((r - l) >> 1);
+        auto [lo_l, hi_l] = split(pool[n].l, l, m, k);
+        auto [lo_r, hi_r] = split(pool[n].r, m, r, k);
+        uint32_t t = pool.alloc(Node{ID, hi_l, hi_r});
+        pool[n].l = lo_l; pool[n].r = lo_r;
+        if(!lo_l && !lo_r){ pool.release(n); n = 0; } else pull(n);
+        if(!hi_l && !hi_r){ pool.release(t); t = 0; } else pull(t);
+        return {n, t};
+    }
 
-    void set_point(Node* &n, long long l, long long r, long long p, const T& v){
-        if(p < l || p >= r) return;
-        ensure(n);
-        if(l + 1 == r){ n->val = v; return; }
+    // Trả về chỉ số node sau khi cập nhật (node mới nếu n = 0)
+    uint32_t set_point(uint32_t n, long long l, long long r, long long p, const T& v){
+        if(p < l || p >= r) return n;
+        n = ensure(n);
+        if(l + 1 == r){ pool[n].val = v; return n; }
         long long m = l + ((r - l) >> 1);
-        if(p < m) set_point(n->l, l, m, p, v); else set_point(n->r, m, r, p, v);
+        if(p < m){ uint32_t c = set_point(pool[n].l, l, m, p, v); pool[n].l = c; }
+        else     { uint32_t c = set_point(pool[n].r, m, r, p, v); pool[n].r = c; }
         pull(n);
+        return n;
+    }
+
+    // Như set_point nhưng không ghi vào node cũ: mọi node trên đường đi được sao chép
+    uint32_t set_point_copy(uint32_t n, long long l, long long r, long long p, const T& v){
+        if(p < l || p >= r) return n;
+        Node copy = pool[n]; // n = 0 -> bản sao của node null (val = ID, không con)
+        uint32_t c = pool.alloc(copy);
+        if(l + 1 == r){ pool[c].val = v; return c; }
+        long long m = l + ((r - l) >> 1);
+        if(p < m){ uint32_t k = set_point_copy(copy.l, l, m, p, v); pool[c].l = k; }
+        else     { uint32_t k = set_point_copy(copy.r, m, r, p, v); pool[c].r = k; }
+        pull(c);
+        return c;
     }
 
-    T query(Node* n, long long l, long long r, long long ql, long long qr) const {
+    template<class It>
+    uint32_t set_points(uint32_t n, long long l, long long r, It first, It last){
+        if(first == last) return n;
+        if(next(first) == last) return set_point(n, l, r, first->first, first->second); // còn 1 điểm
+        n = ensure(n);
+        if(l + 1 == r){ pool[n].val = prev(last)->second; return n; }
+        long long m = l + ((r - l) >> 1);
+        It mid = partition_point(first, last, [m](const auto& x){ return x.first < m; });
+        uint32_t c = set_points(pool[n].l, l, m, first, mid); pool[n].l = c;
+        c = set_points(pool[n].r, m, r, mid, last); pool[n].r = c;
+        pull(n);
+        return n;
+    }
+
+    T query(uint32_t n, long long l, long long r, long long ql, long long qr) const {
         if(!n || qr <= l || r <= ql) return ID;
-        if(ql <= l && r <= qr) return n->val;
+        if(ql <= l && r <= qr) return pool[n].val;
         long long m = l + ((r - l) >> 1);
-        return op(query(n->l, l, m, ql, qr), query(n->r, m, r, ql, qr));
+        return op(query(pool[n].l, l, m, ql, qr), query(pool[n].r, m, r, ql, qr));
     }
 };
 
 /* ========================================================================
- * 2) DynLazySegTreeAddSum — range add + range sum (long long)
- *    - Tổng hợp theo SUM; cập nhật là cộng (add) trên đoạn.
- *    - Hữu ích cho bài hình chữ nhật 1D trên miền dài (nhiều lần cộng và hỏi tổng).
+ * 2) DynLazySegTree<Monoid, Action> — range apply + range query (lazy tổng quát)
+ *    Monoid: using S; static S e(); static S op(S a, S b);
+ *    Action: using F; static S mapping(F f, S s, long long len);   // f tác động lên đoạn dài len có giá trị s
+ *            static F composition(F f, F g);                       // f ∘ g: áp g trước rồi f
+ *    - Yêu cầu như lazy segtree thường: mapping phân phối qua op
+ *      (mapping(f, op(a,b), la+lb) = op(mapping(f,a,la), mapping(f,b,lb))).
+ *    - Mọi điểm ban đầu mang giá trị e(); node chưa tạo cũng là e(), nên mapping(f, e(), len)
+ *      phải trả về đúng (vd min + add: giữ nguyên INF).
+ *    - Tuỳ chọn `static F id()` (F có ==): node không cần cờ `has`, lz == id() nghĩa là không có lazy
+ *      (add/sum: node 24 byte thay vì 32). Không có id(): node mang thêm cờ `has`.
+ *    - query/max_right/min_left là const: không push, mang lazy của tổ tiên đi xuống thay vào đó.
  * ====================================================================== */
-struct DynLazySegTreeAddSum {
-    struct Node { long long sum=0, add=0; Node *l=nullptr, *r=nullptr; };
+template<class A, class = void> struct action_has_id : false_type {};
+template<class A> struct action_has_id<A, void_t<decltype(A::id())>> : true_type {};
+
+template<class S, class F, bool flag> struct DynLazyNode { S val; F lz{}; uint32_t l=0, r=0; bool has=false; };
+template<class S, class F> struct DynLazyNode<S, F, false> { S val; F lz{}; uint32_t l=0, r=0; };
+
+template<class Monoid, class Action>
+struct DynLazySegTree {
+    using S = typename Monoid::S;
+    using F = typename Action::F;
+    static constexpr bool HAS_ID = action_has_id<Action>::value;
+    using Node = DynLazyNode<S, F, !HAS_ID>;
+
     long long L, R; // [L, R)
-    Node* root = nullptr;
+    NodePool<Node> pool;
+    uint32_t root = 0;
 
-    explicit DynLazySegTreeAddSum(long long L, long long R): L(L), R(R) { assert(L < R); }
+    DynLazySegTree(long long L, long long R): L(L), R(R), pool(blank()) { assert(L < R); }
 
-    // Cộng delta trên [ql, qr)
-    void range_add(long long ql, long long qr, long long delta){ range_add(root, L, R, ql, qr, delta); }
-    // Truy vấn tổng trên [ql, qr)
-    long long range_sum(long long ql, long long qr) const { return range_sum(root, L, R, ql, qr); }
+    // Áp f lên mọi phần tử trong [ql, qr)
+    void apply(long long ql, long long qr, const F& f){ if(ql < qr) root = apply(root, L, R, ql, qr, f); }
+    // Gộp trên [ql, qr)
+    S query(long long ql, long long qr) const { return ql < qr ? query(root, L, R, ql, qr) : Monoid::e(); }
+    S get_point(long long p) const { return query(p, p+1); }
+
+    // r lớn nhất trong [ql, R] với g(op(a[ql..r))) đúng (g đơn điệu, g(e()) đúng)
+    template<class G>
+    long long max_right(long long ql, G g) const {
+        assert(L <= ql && ql <= R && g(Monoid::e()));
+        S sm = Monoid::e();
+        long long res = R;
+        if(ql < R) max_right(root, L, R, ql, g, sm, F{}, false, res);
+        return res;
+    }
+    // l nhỏ nhất trong [L, qr] với g(op(a[l..qr))) đúng
+    template<class G>
+    long long min_left(long long qr, G g) const {
+        assert(L <= qr && qr <= R && g(Monoid::e()));
+        S sm = Monoid::e();
+        long long res = L;
+        if(L < qr) min_left(root, L, R, qr, g, sm, F{}, false, res);
+        return res;
+    }
+
+    void clear(){ pool.clear(); root = 0; }
+    void reserve(size_t nodes){ pool.reserve(nodes); }
 
 private:
-    static inline long long seg_len(long long l, long long r){ return r - l; }
-    static inline void ensure(Node* &n){ if(!n) n = new Node(); }
+    static Node blank(){
+        Node x{Monoid::e()};
+        if constexpr(HAS_ID) x.lz = Action::id();
+        return x;
+    }
+    static bool has_lz(const Node& x){
+        if constexpr(HAS_ID) return !(x.lz == Action::id());
+        else return x.has;
+    }
+    static void drop_lz(Node& x){
+        if constexpr(HAS_ID) x.lz = Action::id();
+        else x.has = false;
+    }
+
+    uint32_t ensure(uint32_t n){ return n ? n : pool.alloc(blank()); }
 
-    // Áp dụng lazy lên node (không đi xuống)
-    static inline void apply(Node* &n, long long l, long long r, long long delta){
-        ensure(n);
-        n->sum += delta * seg_len(l, r);
-        n->add += delta;
+    // Áp f lên cả node (không đi xuống); trả về chỉ số node (tạo mới nếu n = 0)
+    uint32_t apply_node(uint32_t n, long long len, const F& f){
+        n = ensure(n);
+        Node& x = pool[n]; // không cấp phát sau dòng này -> tham chiếu an toàn
+        x.val = Action::mapping(f, x.val, len);
+        if constexpr(HAS_ID) x.lz = Action::composition(f, x.lz);
+        else { x.lz = x.has ? Action::composition(f, x.lz) : f; x.has = true; }
+        return n;
     }
 
-    static inline void push(Node* n, long long l, long long r){
-        if(!n || n->add == 0 || l + 1 == r) return;
+    void push(uint32_t n, long long l, long long r){
+        if(!has_lz(pool[n]) || l + 1 == r) return;
+        F f = pool[n].lz;
+        drop_lz(pool[n]);
         long long m = l + ((r - l) >> 1);
-        // tạo con khi cần và đẩy lazy
-        apply(n->l, l, m, n->add);
-        apply(n->r, m, r, n->add);
-        n->add = 0;
+        // apply_node có thể giãn pool -> đọc lại pool[n] sau mỗi lần gọi
+        uint32_t c = apply_node(pool[n].l, m - l, f); pool[n].l = c;
+        c = apply_node(pool[n].r, r - m, f); pool[n].r = c;
     }
 
-    static inline void pull(Node* n){
-        long long left = n->l ? n->l->sum : 0;
-        long long right = n->r ? n->r->sum : 0;
-        n->sum = left + right;
-    }
+    void pull(uint32_t n){ pool[n].val = Monoid::op(pool[pool[n].l].val, pool[pool[n].r].val); }
 
-    void range_add(Node* &n, long long l, long long r, long long ql, long long qr, long long delta){
-        if(qr <= l || r <= ql) return;
-        if(ql <= l && r <= qr){ apply(n, l, r, delta); return; }
-        ensure(n); push(n, l, r);
+    uint32_t apply(uint32_t n, long long l, long long r, long long ql, long long qr, const F& f){
+        if(qr <= l || r <= ql) return n;
+        if(ql <= l && r <= qr) return apply_node(n, r - l, f);
+        n = ensure(n); push(n, l, r);
         long long m = l + ((r - l) >> 1);
-        range_add(n->l, l, m, ql, qr, delta);
-        range_add(n->r, m, r, ql, qr, delta);
+        uint32_t c = apply(pool[n].l, l, m, ql, qr, f); pool[n].l = c;
+        c = apply(pool[n].r, m, r, ql, qr, f); pool[n].r = c;
         pull(n);
+        return n;
+    }
+
+    S query(uint32_t n, long long l, long long r, long long ql, long long qr) const {
+        if(!n || qr <= l || r <= ql) return Monoid::e();
+        if(ql <= l && r <= qr) return pool[n].val;
+        long long m = l + ((r - l) >> 1);
+        S res = Monoid::op(query(pool[n].l, l, m, ql, qr), query(pool[n].r, m, r, ql, qr));
+        // lazy của n chưa xuống con: áp lên phần giao (hợp lệ nhờ tính phân phối)
+        if(has_lz(pool[n])) res = Action::mapping(pool[n].lz, res, min(r, qr) - max(l, ql));
+        return res;
+    }
+
+    // acc = hợp các lazy của tổ tiên (chưa nằm trong pool[n].val); true = đã dừng, res đã đặt
+    template<class G>
+    bool max_right(uint32_t n, long long l, long long r, long long ql, G& g, S& sm,
+                   const F& acc, bool has, long long& res) const {
+        if(r <= ql) return false;
+        if(ql <= l){
+            S nx = Monoid::op(sm, has ? Action::mapping(acc, pool[n].val, r - l) : pool[n].val);
+            if(g(nx)){ sm = nx; return false; }
+            if(l + 1 == r){ res = l; return true; }
+        }
+        long long m = l + ((r - l) >> 1);
+        F acc2 = acc; bool has2 = has;
+        if(has_lz(pool[n])){ acc2 = has ? Action::composition(acc, pool[n].lz) : pool[n].lz; has2 = true; }
+        return max_right(pool[n].l, l, m, ql, g, sm, acc2, has2, res)
+            || max_right(pool[n].r, m, r, ql, g, sm, acc2, has2, res);
     }
 
-    long long range_sum(Node* n, long long l, long long r, long long ql, long long qr) const {
-        if(!n || qr <= l || r <= ql) return 0LL;
-        if(ql <= l && r <= qr) return n->sum;
+    template<class G>
+    bool min_left(uint32_t n, long long l, long long r, long long qr, G& g, S& sm,
+                  const F& acc, bool has, long long& res) const {
+        if(qr <= l) return false;
+        if(r <= qr){
+            S nx = Monoid::op(has ? Action::mapping(acc, pool[n].val, r - l) : pool[n].val, sm);
+            if(g(nx)){ sm = nx; return false; }
+            if(l + 1 == r){ res = r; return true; }
+        }
         long long m = l + ((r - l) >> 1);
-        // Không gọi push const; tính đúng vì sum của n đã bao hàm lazy tại n.
-        return range_sum(n->l, l, m, ql, qr) + range_sum(n->r, m, r, ql, qr);
+        F acc2 = acc; bool has2 = has;
+        if(has_lz(pool[n])){ acc2 = has ? Action::composition(acc, pool[n].lz) : pool[n].lz; has2 = true; }
+        return min_left(pool[n].r, m, r, qr, g, sm, acc2, has2, res)
+            || min_left(pool[n].l, l, m, qr, g, sm, acc2, has2, res);
+    }
+};
+
+/* ========================================================================
+ * 3) DynLazySegTreeAddSum — range add + range sum (long long)
+ *    - Trường hợp riêng của DynLazySegTree, giữ tên hàm cũ range_add/range_sum.
+ *    - Hữu ích cho bài hình chữ nhật 1D trên miền dài (nhiều lần cộng và hỏi tổng).
+ * ====================================================================== */
+struct SumMonoid {
+    using S = long long;
+    static S e(){ return 0; }
+    static S op(S a, S b){ return a + b; }
+};
+struct AddAction {
+    using F = long long;
+    static long long mapping(F f, long long s, long long len){ return s + f * len; }
+    static F composition(F f, F g){ return f + g; }
+    static F id(){ return 0; }
+};
+
+struct DynLazySegTreeAddSum : DynLazySegTree<SumMonoid, AddAction> {
+    explicit DynLazySegTreeAddSum(long long L, long long R): DynLazySegTree(L, R) {}
+
+    // Cộng delta trên [ql, qr)
+    void range_add(long long ql, long long qr, long long delta){ apply(ql, qr, delta); }
+    // Truy vấn tổng trên [ql, qr)
+    long long range_sum(long long ql, long long qr) const { return query(ql, qr); }
+};
+static_assert(sizeof(DynLazySegTree<SumMonoid, AddAction>::Node) == 24, "node add/sum phải giữ 24 byte");
+
+/* ========================================================================
+ * 4) ConcurrentDynSegTree — 1 thread ghi, nhiều thread đọc không khoá (kiểu RCU)
+ *    - Ghi: set_point sao chép đường đi (như bản persistent) rồi công bố root mới bằng một
+ *      atomic store; node cũ trên đường đi bị "retire", chỉ tái dùng khi không reader nào còn thấy.
+ *    - Đọc: Snapshot ghim epoch hiện tại + root lúc tạo; mọi truy vấn trên cùng snapshot
+ *      thấy cùng một phiên bản. Node không bao giờ bị sửa khi còn đến được => đọc không khoá.
+ *    - Thu hồi theo epoch: lô retire ở epoch t được trả về danh sách tự do khi mọi reader đang
+ *      hoạt động đã ghim epoch > t. Một reader giữ snapshot quá lâu chỉ làm chậm việc thu hồi.
+ *    - Bộ nhớ node chia khối 2^CHUNK_BITS, bảng khối cố định => địa chỉ node không đổi khi cây lớn
+ *      (không dùng NodePool vì vector giãn sẽ di chuyển node dưới chân reader).
+ *    - Tối đa MAX_READERS thread đọc, mỗi thread gọi register_reader() một lần. T phải có hàm tạo mặc định.
+ *    - Thứ tự bộ nhớ: ghi slot/đọc root của reader và ghi root/quét slot của writer đều seq_cst,
+ *      nên reader vừa vào mà writer chưa thấy chắc chắn đọc được root mới.
+ * ====================================================================== */
+template<class T, class Op>
+struct ConcurrentDynSegTree {
+    struct Node { T val; uint32_t l=0, r=0; };
+    static constexpr int CHUNK_BITS = 16, MAX_CHUNKS = 1 << 16, MAX_READERS = 64;
+    static constexpr uint32_t MASK = (1u << CHUNK_BITS) - 1;
+    static constexpr uint64_t IDLE = UINT64_MAX;
+    static constexpr size_t RECLAIM_BATCH = 4096;
+
+    long long L, R;   // miền gốc [L, R)
+    T ID;             // phần tử đơn vị
+    Op op;            // phép gộp
+
+    ConcurrentDynSegTree(long long L, long long R, T id, Op op)
+        : L(L), R(R), ID(id), op(op), chunks(MAX_CHUNKS) { assert(L < R); alloc(Node{id}); } // chỉ số 0 = null
+
+    /* ---------- Reader ---------- */
+    int register_reader(){ int id = n_readers.fetch_add(1); assert(id < MAX_READERS); return id; }
+
+    struct Snapshot {
+        const ConcurrentDynSegTree* t; int id; uint32_t rt;
+        Snapshot(const ConcurrentDynSegTree* t, int id): t(t), id(id) {
+            t->slots[id].e.store(t->epoch.load(), memory_order_seq_cst);
+            rt = t->root.load(memory_order_seq_cst);
+        }
+        ~Snapshot(){ t->slots[id].e.store(IDLE, memory_order_release); }
+        Snapshot(const Snapshot&) = delete;
+        Snapshot& operator=(const Snapshot&) = delete;
+        T query(long long ql, long long qr) const { return t->query(rt, t->L, t->R, ql, qr); }
+    };
+    // Mỗi reader giữ tối đa một Snapshot tại một thời điểm
+    Snapshot snapshot(int reader_id) const { return Snapshot(this, reader_id); }
+    T query(int reader_id, long long ql, long long qr) const { return snapshot(reader_id).query(ql, qr); }
+
+    /* ---------- Writer (chỉ một thread) ---------- */
+    void set_point(long long p, const T& v){
+        uint32_t nr = copy_path(root.load(memory_order_relaxed), L, R, p, v);
+        root.store(nr, memory_order_seq_cst);
+        uint64_t t = epoch.fetch_add(1, memory_order_seq_cst);
+        for(uint32_t i : pending) retired.push_back({t, i});
+        pending.clear();
+        if(retired.size() >= RECLAIM_BATCH) reclaim(); // quét slot thưa để không tranh cache line với reader
+    }
+
+    // Trả các lô không reader nào còn thấy về danh sách tự do
+    void reclaim(){
+        if(retired.empty()) return;
+        uint64_t mn = IDLE;
+        for(int i = 0, k = min(n_readers.load(), MAX_READERS); i < k; i++) mn = min(mn, slots[i].e.load(memory_order_seq_cst));
+        while(!retired.empty() && retired.front().first < mn){ freed.push_back(retired.front().second); retired.pop_front(); }
+    }
+
+    size_t live_nodes() const { return n_alloc - 1 - freed.size() - retired.size(); }
+    size_t retired_nodes() const { return retired.size(); }
+
+private:
+    struct alignas(64) Slot { atomic<uint64_t> e{IDLE}; }; // epoch reader đang ghim
+
+    vector<unique_ptr<Node[]>> chunks; // kích thước cố định MAX_CHUNKS, không bao giờ giãn
+    uint32_t n_alloc = 0;
+    vector<uint32_t> freed, pending;
+    deque<pair<uint64_t, uint32_t>> retired; // (epoch, node), epoch tăng dần
+    atomic<uint32_t> root{0};
+    atomic<uint64_t> epoch{1};
+    atomic<int> n_readers{0};
+    mutable Slot slots[MAX_READERS];
+
+    const Node& node(uint32_t i) const { return chunks[i >> CHUNK_BITS][i & MASK]; }
+
+    uint32_t alloc(const Node& x){
+        uint32_t i;
+        if(!freed.empty()){ i = freed.back(); freed.pop_back(); }
+        else {
+            i = n_alloc++;
+            assert((i >> CHUNK_BITS) < MAX_CHUNKS);
+            if(!(i & MASK)) chunks[i >> CHUNK_BITS].reset(new Node[1u << CHUNK_BITS]);
+        }
+        chunks[i >> CHUNK_BITS][i & MASK] = x;
+        return i;
+    }
+
+    // Node mới ghi xong trước khi root được công bố; node cũ trên đường đi vào pending
+    uint32_t copy_path(uint32_t n, long long l, long long r, long long p, const T& v){
+        if(p < l || p >= r) return n;
+        Node c = node(n);
+        if(n) pending.push_back(n);
+        if(l + 1 == r){ c.val = v; return alloc(c); }
+        long long m = l + ((r - l) >> 1);
+        if(p < m) c.l = copy_path(c.l, l, m, p, v); else c.r = copy_path(c.r, m, r, p, v);
+        c.val = op(node(c.l).val, node(c.r).val);
+        return alloc(c);
+    }
+
+    T query(uint32_t n, long long l, long long r, long long ql, long long qr) const {
+        if(!n || qr <= l || r <= ql) return ID;
+        if(ql <= l && r <= qr) return node(n).val;
+        long long m = l + ((r - l) >> 1);
+        return op(query(node(n).l, l, m, ql, qr), query(node(n).r, m, r, ql, qr));
     }
 };
 
@@ -156,6 +535,16 @@ private:
 // st.range_add(10, 20, +5);   // cộng +5 cho mọi i in [10,20)
 // st.range_add(15, 18, +2);
 // cout << st.range_sum(0, 100) << "\n"; // tổng trên [0,100)
+// cout << st.max_right(0, [](long long s){ return s <= 30; }) << "\n"; // tiền tố tổng <= 30 dài nhất
+
+// Lazy tổng quát: gán trên đoạn + max trên đoạn
+// struct MaxM { using S = long long; static S e(){ return LLONG_MIN; } static S op(S a, S b){ return max(a,b); } };
+// struct Assign { using F = long long;
+//     static long long mapping(F f, long long, long long){ return f; }
+//     static F composition(F f, F){ return f; } };
+// DynLazySegTree<MaxM, Assign> mx(0, (long long)1e18);
+// mx.apply(5, 1000, 7);
+// cout << mx.query(0, 10) << "\n"; // 7
 
 // Monoid tuỳ biến (ví dụ Max) với point set + range query:
 // auto op = [](long long a, long long b){ return max(a,b); };
@@ -163,6 +552,31 @@ private:
 // DynSegTreeMonoid<long long, decltype(op)> t(0, (long long)1e18, NEG, op);
 // t.set_point(1234567890123LL, 42);
 // cout << t.query(0, 2e12) << "\n"; // max trên [0, 2e12)
+// vector<pair<long long,long long>> batch = {{5, 1}, {9, 7}, {1000000, 3}}; // đã sắp theo khoá
+// t.set_points(batch);              // một lần đi xuống cho cả lô
+
+// Persistent: mỗi lần gán sinh một phiên bản
+// vector<uint32_t> ver = {0};                       // phiên bản 0: cây rỗng
+// ver.push_back(t.set_point(ver.back(), 7, 10));
+// ver.push_back(t.set_point(ver.back(), 9, 20));
+// cout << t.query(ver[1], 0, 100) << " " << t.query(ver[2], 0, 100) << "\n"; // 10 20
+// t.gc({ver[2]});                                   // bỏ phiên bản 1, node của nó được dùng lại
+
+// Gộp cây theo đỉnh (thay dsu_on_tree + map): đếm số lần xuất hiện màu trong cây con
+// auto add = [](long long a, long long b){ return a + b; };
+// DynSegTreeMonoid<long long, decltype(add)> cnt(0, MAXC, 0, add);
+// vector<uint32_t> rt(n);
+// dfs(v): rt[v] = cnt.set_point(0, color[v], 1);    // cây mới chỉ có một điểm
+//         for(u : con của v){ dfs(u); rt[v] = cnt.merge(rt[v], rt[u]); }
+//         ans[v] = cnt.query(rt[v], lo, hi);
+// auto [lo_part, hi_part] = cnt.split(rt[0], 100);   // màu < 100 | màu >= 100
+
+// Một thread ghi, nhiều thread đọc (biên dịch kèm -pthread):
+// ConcurrentDynSegTree<long long, decltype(op)> ct(0, (long long)1e18, NEG, op);
+// thread rd([&]{ int id = ct.register_reader();
+//                auto s = ct.snapshot(id); cout << s.query(0, 100) << "\n"; });
+// ct.set_point(5, 10);                              // writer: không cần khoá
+// rd.join();
 
 /* ---------------- Gợi ý tuỳ chỉnh ------------------
 1) Đổi phép gộp (sum/min/max/xor...):
@@ -173,13 +587,17 @@ private:
    - Lấy `old = t.get_point(p)` rồi `t.set_point(p, old + delta)`.
    - Hoặc tự thêm hàm `add_point` tương tự `set_point` nhưng cộng tại lá.
 
-3) Lazy khác ngoài cộng:
-   - Cần thiết kế `apply(node, len, tag)` và `push/compose` tương ứng.
-   - Ví dụ range assign + range sum: tag ghi (hasAssign, assignVal, addDelta) và ưu tiên assign ghi đè add; cẩn thận khi `push`.
+3) Lazy khác ngoài cộng: viết cặp Monoid/Action cho DynLazySegTree, ví dụ
+   - assign + sum:  mapping = f * len;                    composition(f, g) = f
+   - add + min:     mapping = s == INF ? s : s + f;       composition = f + g   (INF = e(), node chưa tạo)
+   - affine + sum (f = (a, b): x -> a*x + b, dùng mint):
+                    mapping = a*s + b*len;                composition(f, g) = (f.a*g.a, f.a*g.b + f.b)
+   - Cần tính phân phối qua op; len là độ dài đoạn của node (hoặc phần giao khi query).
 
 4) Tối ưu bộ nhớ/hiệu năng:
    - Tránh tạo node khi không cần (chỉ tạo khi cập nhật đi qua hoặc cần lưu lazy).
    - Truy vấn không tạo node mới, chỉ đọc.
-   - Với nhiều thao tác, cân nhắc pool/arena để giảm chi phí `new`.
+   - Node đã nằm trong NodePool; gọi reserve(số node dự kiến) để tránh giãn vector,
+     clear() giữa các test thay vì tạo cây mới.
 */
 
@@ -10,6 +10,20 @@
  *   2) ImplicitTreap: treats an array as a BST by index; supports split/merge, insert/delete by position,
  *      reverse on range (lazy), and range sum query
  *
+ * Storage
+ * - Nodes live in a per-treap vector (`a`), children are 32-bit indices, a[0] is the null node
+ *   (sz = 0, sum = 0). Erased nodes go to a free list and are reused; clear() drops everything.
+ * - Priority is not stored: pr(t) hashes the node index with a per-run seed (bijective, so no ties).
+ *   Node size: KeyedTreap 24 bytes, ImplicitTreap 32 bytes, and no per-node malloc.
+ * - split/merge/insert/erase are iterative (top-down with hooks, sizes fixed by a path stack).
+ * - Pointers returned by find_by_order/lower_bound are valid until the next insertion.
+ *
+ * Bulk loading
+ * - KeyedTreap::build_sorted / ImplicitTreap::build: O(N) Cartesian-tree construction with a stack
+ *   (input in BST order, so only the heap order has to be fixed).
+ * - KeyedTreap::insert_sorted: builds the batch in O(m), then unites it with the existing treap in
+ *   expected O(m log(n/m + 1)) — much cheaper than m single inserts when m is large.
+ *
  * Typical Uses
  * - Replacement for PBDS ordered_set when portability matters
  * - Maintain a dynamic sequence with cut/paste, reverse, k-th, sum/min, etc.
@@ -21,8 +35,20 @@
 using namespace std;
 
 /* ---------------- RNG ---------------- */
+// Kept for code that includes this file and calls rng(); the treaps below no longer use it.
 static mt19937 rng((uint32_t)chrono::steady_clock::now().time_since_epoch().count());
 
+/* ---------------- Priority ---------------- */
+// Min-heap on pr: a node with smaller pr sits above. lowbias32 hash of (index ^ seed).
+static const uint32_t TREAP_SEED = (uint32_t)chrono::steady_clock::now().time_since_epoch().count();
+static inline uint32_t treap_prio(uint32_t i) {
+    uint32_t x = i ^ TREAP_SEED;
+    x ^= x >> 16; x *= 0x7feb352du;
+    x ^= x >> 15; x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
 /* ========================================================================
  * 1) KeyedTreap: multiset-style treap with order statistics
  *    - Stores integer keys (change to long long if needed)
@@ -30,115 +56,182 @@ static mt19937 rng((uint32_t)chrono::steady_clock::now().time_since_epoch().coun
  * ====================================================================== */
 struct KeyedTreap {
     struct Node {
-        long long key;
-        uint32_t pr;
-        Node *l = nullptr, *r = nullptr;
-        int sz = 1;     // size including duplicates
-        int cnt = 1;    // multiplicity of this key
-        explicit Node(long long k, uint32_t p): key(k), pr(p) {}
+        long long key = 0;
+        uint32_t l = 0, r = 0;
+        int sz = 0;     // size including duplicates (0 for the null node)
+        int cnt = 0;    // multiplicity of this key
     };
 
-    Node* root = nullptr;
+    vector<Node> a{Node()};     // a[0] = null node
+    vector<uint32_t> freed;     // erased slots, reused by new_node
+    vector<uint32_t> stk;       // path stack for split/merge
+    uint32_t root = 0;
 
-    static int getsz(Node* t) { return t ? t->sz : 0; }
-    static void pull(Node* t) {
-        if (!t) return;
-        t->sz = t->cnt + getsz(t->l) + getsz(t->r);
+    static uint32_t pr(uint32_t t) { return treap_prio(t); }
+
+    uint32_t new_node(long long k) {
+        Node x; x.key = k; x.sz = x.cnt = 1;
+        if (!freed.empty()) { uint32_t t = freed.back(); freed.pop_back(); a[t] = x; return t; }
+        a.push_back(x);
+        return (uint32_t)a.size() - 1;
     }
+    void pull(uint32_t t) { a[t].sz = a[t].cnt + a[a[t].l].sz + a[a[t].r].sz; }
 
     // Merge assumes all keys in L < all keys in R
-    static Node* merge(Node* L, Node* R) {
-        if (!L || !R) return L ? L : R;
-        if (L->pr < R->pr) {
-            L->r = merge(L->r, R);
-            pull(L);
-            return L;
-        } else {
-            R->l = merge(L, R->l);
-            pull(R);
-            return R;
+    uint32_t merge(uint32_t L, uint32_t R) {
+        uint32_t res = 0, *hook = &res;
+        stk.clear();
+        while (L && R) {
+            if (pr(L) < pr(R)) { *hook = L; stk.push_back(L); hook = &a[L].r; L = a[L].r; }
+            else               { *hook = R; stk.push_back(R); hook = &a[R].l; R = a[R].l; }
         }
+        *hook = L ? L : R;
+        for (size_t i = stk.size(); i--; ) pull(stk[i]);
+        return res;
     }
 
     // Split by key k: left has keys < k, right has keys >= k
-    static pair<Node*, Node*> split_key(Node* t, long long k) {
-        if (!t) return {nullptr, nullptr};
-        if (k <= t->key) {
-            auto res = split_key(t->l, k);
-            t->l = res.second; pull(t);
-            return {res.first, t};
-        } else {
-            auto res = split_key(t->r, k);
-            t->r = res.first; pull(t);
-            return {t, res.second};
+    pair<uint32_t, uint32_t> split_key(uint32_t t, long long k) {
+        uint32_t lt = 0, rt = 0, *lh = &lt, *rh = &rt;
+        stk.clear();
+        while (t) {
+            stk.push_back(t);
+            if (k <= a[t].key) { *rh = t; rh = &a[t].l; t = a[t].l; }
+            else               { *lh = t; lh = &a[t].r; t = a[t].r; }
+        }
+        *lh = *rh = 0;
+        for (size_t i = stk.size(); i--; ) pull(stk[i]);
+        return {lt, rt};
+    }
+
+    // Cartesian build of nodes already in key order (min-heap on pr), O(#nodes).
+    // A node popped from the stack is final, so it is pulled right away.
+    template<class It>
+    uint32_t build_from(It first, It last) {
+        stk.clear();
+        for (It it = first; it != last; ) {
+            long long k = *it;
+            uint32_t x = new_node(k);
+            for (++it; it != last && *it == k; ++it) a[x].cnt++, a[x].sz++;
+            uint32_t child = 0;
+            while (!stk.empty() && pr(stk.back()) > pr(x)) { child = stk.back(); stk.pop_back(); pull(child); }
+            a[x].l = child;
+            if (!stk.empty()) a[stk.back()].r = x;
+            stk.push_back(x);
         }
+        for (size_t i = stk.size(); i--; ) pull(stk[i]);
+        return stk.empty() ? 0 : stk[0];
+    }
+
+    // Union of two treaps (keys may overlap; equal keys add their cnt). Expected O(m log(n/m + 1)).
+    uint32_t unite(uint32_t t1, uint32_t t2) {
+        if (!t1 || !t2) return t1 ^ t2;
+        if (pr(t2) < pr(t1)) swap(t1, t2);
+        long long k = a[t1].key;
+        auto [L, R] = split_key(t2, k);
+        uint32_t eq = R, rest = 0;
+        if (k != LLONG_MAX) tie(eq, rest) = split_key(R, k + 1);
+        if (eq) { a[t1].cnt += a[eq].cnt; freed.push_back(eq); } // eq: at most one node
+        uint32_t l = unite(a[t1].l, L);
+        uint32_t r = unite(a[t1].r, rest);
+        a[t1].l = l; a[t1].r = r;
+        pull(t1);
+        return t1;
+    }
+
+    // Replace the content with sorted keys (duplicates allowed) in O(N)
+    template<class It>
+    void build_sorted(It first, It last) {
+        assert(is_sorted(first, last));
+        clear();
+        reserve(distance(first, last));
+        root = build_from(first, last);
+    }
+    void build_sorted(const vector<long long>& keys) { build_sorted(keys.begin(), keys.end()); }
+
+    // Insert a sorted batch of m keys into the current n keys
+    template<class It>
+    void insert_sorted(It first, It last) {
+        assert(is_sorted(first, last));
+        root = unite(root, build_from(first, last));
     }
+    void insert_sorted(const vector<long long>& keys) { insert_sorted(keys.begin(), keys.end()); }
 
     // Insert key (duplicates aggregated in cnt)
-    static void insert(Node* &t, long long k, uint32_t pr) {
-        if (!t) { t = new Node(k, pr); return; }
-        if (k == t->key) { t->cnt++; pull(t); return; }
-        if (pr < t->pr) {
-            auto [L, R] = split_key(t, k);
-            t = new Node(k, pr);
-            t->l = L; t->r = R; pull(t);
+    void insert(long long k) {
+        for (uint32_t t = root; t; t = k < a[t].key ? a[t].l : a[t].r) {
+            if (a[t].key != k) continue;
+            for (uint32_t u = root; u != t; u = k < a[u].key ? a[u].l : a[u].r) a[u].sz++;
+            a[t].cnt++; a[t].sz++;
             return;
         }
-        if (k < t->key) insert(t->l, k, pr);
-        else insert(t->r, k, pr);
-        pull(t);
+        uint32_t x = new_node(k);   // allocate before taking hooks into a
+        uint32_t* hook = &root;
+        while (*hook && pr(*hook) < pr(x)) {
+            uint32_t t = *hook;
+            a[t].sz++;
+            hook = k < a[t].key ? &a[t].l : &a[t].r;
+        }
+        auto [L, R] = split_key(*hook, k);
+        a[x].l = L; a[x].r = R; pull(x);
+        *hook = x;
     }
 
     // Erase one occurrence of k (if exists)
-    static void erase(Node* &t, long long k) {
-        if (!t) return;
-        if (k == t->key) {
-            if (t->cnt > 1) { t->cnt--; pull(t); return; }
-            Node* u = merge(t->l, t->r);
-            delete t; t = u; return;
+    void erase(long long k) {
+        if (!contains(k)) return;
+        uint32_t* hook = &root;
+        while (a[*hook].key != k) {
+            uint32_t t = *hook;
+            a[t].sz--;
+            hook = k < a[t].key ? &a[t].l : &a[t].r;
         }
-        if (k < t->key) erase(t->l, k); else erase(t->r, k);
-        pull(t);
+        uint32_t t = *hook;
+        if (a[t].cnt > 1) { a[t].cnt--; a[t].sz--; return; }
+        *hook = merge(a[t].l, a[t].r);
+        freed.push_back(t);
     }
 
     // Lower bound: smallest node with key >= k (nullptr if none)
-    static Node* lower_bound(Node* t, long long k) {
-        Node* ans = nullptr;
-        while (t) {
-            if (t->key >= k) { ans = t; t = t->l; }
-            else t = t->r;
+    const Node* lower_bound(long long k) const {
+        uint32_t ans = 0;
+        for (uint32_t t = root; t; ) {
+            if (a[t].key >= k) { ans = t; t = a[t].l; }
+            else t = a[t].r;
         }
-        return ans;
+        return ans ? &a[ans] : nullptr;
     }
 
     // Count elements < k
-    static int order_of_key(Node* t, long long k) {
-        if (!t) return 0;
-        if (k <= t->key) return order_of_key(t->l, k);
-        return t->cnt + getsz(t->l) + order_of_key(t->r, k);
+    int order_of_key(long long k) const {
+        int res = 0;
+        for (uint32_t t = root; t; ) {
+            if (k <= a[t].key) t = a[t].l;
+            else { res += a[t].cnt + a[a[t].l].sz; t = a[t].r; }
+        }
+        return res;
     }
 
     // Find k-th element (0-based). Returns pointer or nullptr if out-of-range
-    static Node* find_by_order(Node* t, int k) {
-        if (!t || k < 0 || k >= getsz(t)) return nullptr;
-        int L = getsz(t->l);
-        if (k < L) return find_by_order(t->l, k);
-        if (k < L + t->cnt) return t;
-        return find_by_order(t->r, k - L - t->cnt);
+    const Node* find_by_order(int k) const {
+        if (k < 0 || k >= size()) return nullptr;
+        uint32_t t = root;
+        while (true) {
+            int L = a[a[t].l].sz;
+            if (k < L) t = a[t].l;
+            else if (k < L + a[t].cnt) return &a[t];
+            else { k -= L + a[t].cnt; t = a[t].r; }
+        }
     }
 
-    // Public wrappers
-    void insert(long long k) { insert(root, k, rng()); }
-    void erase(long long k) { erase(root, k); }
-    int size() const { return getsz(root); }
-    bool empty() const { return root == nullptr; }
-    int order_of_key(long long k) const { return order_of_key(root, k); }
-    const Node* find_by_order(int k) const { return find_by_order(root, k); }
-    const Node* lower_bound(long long k) const { return lower_bound(root, k); }
+    int size() const { return a[root].sz; }
+    bool empty() const { return root == 0; }
     bool contains(long long k) const {
-        auto* p = lower_bound(root, k);
+        auto* p = lower_bound(k);
         return p && p->key == k;
     }
+    void clear() { a.resize(1); freed.clear(); root = 0; }
+    void reserve(size_t n) { a.reserve(n + 1); }
 };
 
 
@@ -151,81 +244,96 @@ struct ImplicitTreap {
     struct Node {
         long long val = 0;  // payload
         long long sum = 0;  // aggregator: sum over subtree
-        uint32_t pr = 0;    // heap priority
-        Node *l = nullptr, *r = nullptr;
-        int sz = 1;
+        uint32_t l = 0, r = 0;
+        int sz = 0;
         bool rev = false;   // lazy reverse flag
-        Node() {}
-        Node(long long v, uint32_t p): val(v), sum(v), pr(p) {}
     };
 
-    Node* root = nullptr;
+    vector<Node> a{Node()};     // a[0] = null node
+    vector<uint32_t> freed;
+    vector<uint32_t> stk;
+    uint32_t root = 0;
 
-    static int getsz(Node* t) { return t ? t->sz : 0; }
-    static long long getsum(Node* t) { return t ? t->sum : 0; }
+    static uint32_t pr(uint32_t t) { return treap_prio(t); }
+
+    uint32_t new_node(long long v) {
+        Node x; x.val = x.sum = v; x.sz = 1;
+        if (!freed.empty()) { uint32_t t = freed.back(); freed.pop_back(); a[t] = x; return t; }
+        a.push_back(x);
+        return (uint32_t)a.size() - 1;
+    }
 
-    static void apply_rev(Node* t) {
+    void apply_rev(uint32_t t) {
         if (!t) return;
-        t->rev ^= 1;
-        swap(t->l, t->r);
+        a[t].rev ^= 1;
+        swap(a[t].l, a[t].r);
     }
 
-    static void push(Node* t) {
-        if (!t || !t->rev) return;
-        apply_rev(t->l);
-        apply_rev(t->r);
-        t->rev = false;
+    void push(uint32_t t) {
+        if (!a[t].rev) return;
+        apply_rev(a[t].l);
+        apply_rev(a[t].r);
+        a[t].rev = false;
     }
 
-    static void pull(Node* t) {
-        if (!t) return;
+    void pull(uint32_t t) {
         // Ensure children are in correct state for aggregates
         // (call push on children before using their sums if using more complex lazies)
-        t->sz = 1 + getsz(t->l) + getsz(t->r);
-        t->sum = t->val + getsum(t->l) + getsum(t->r);
+        a[t].sz = 1 + a[a[t].l].sz + a[a[t].r].sz;
+        a[t].sum = a[t].val + a[a[t].l].sum + a[a[t].r].sum;
     }
 
     // Split by position: left has first k elements (0-based), right has the rest
-    static pair<Node*, Node*> split_pos(Node* t, int k) {
-        if (!t) return {nullptr, nullptr};
-        push(t);
-        if (getsz(t->l) >= k) {
-            auto res = split_pos(t->l, k);
-            t->l = res.second; pull(t);
-            return {res.first, t};
-        } else {
-            auto res = split_pos(t->r, k - getsz(t->l) - 1);
-            t->r = res.first; pull(t);
-            return {t, res.second};
+    pair<uint32_t, uint32_t> split_pos(uint32_t t, int k) {
+        uint32_t lt = 0, rt = 0, *lh = &lt, *rh = &rt;
+        stk.clear();
+        while (t) {
+            push(t);
+            stk.push_back(t);
+            int ls = a[a[t].l].sz;
+            if (ls >= k) { *rh = t; rh = &a[t].l; t = a[t].l; }
+            else         { k -= ls + 1; *lh = t; lh = &a[t].r; t = a[t].r; }
         }
+        *lh = *rh = 0;
+        for (size_t i = stk.size(); i--; ) pull(stk[i]);
+        return {lt, rt};
     }
 
-    static Node* merge(Node* L, Node* R) {
-        if (!L || !R) return L ? L : R;
-        if (L->pr < R->pr) {
-            push(L);
-            L->r = merge(L->r, R);
-            pull(L);
-            return L;
-        } else {
-            push(R);
-            R->l = merge(L, R->l);
-            pull(R);
-            return R;
+    uint32_t merge(uint32_t L, uint32_t R) {
+        uint32_t res = 0, *hook = &res;
+        stk.clear();
+        while (L && R) {
+            if (pr(L) < pr(R)) { push(L); *hook = L; stk.push_back(L); hook = &a[L].r; L = a[L].r; }
+            else               { push(R); *hook = R; stk.push_back(R); hook = &a[R].l; R = a[R].l; }
+        }
+        *hook = L ? L : R;
+        for (size_t i = stk.size(); i--; ) pull(stk[i]);
+        return res;
+    }
+
+    // Return every node of subtree t to the free list
+    void free_tree(uint32_t t) {
+        stk.assign(1, t);
+        while (!stk.empty()) {
+            uint32_t u = stk.back(); stk.pop_back();
+            if (!u) continue;
+            stk.push_back(a[u].l); stk.push_back(a[u].r);
+            freed.push_back(u);
         }
     }
 
     // Insert value v at position pos (0-based)
     void insert_at(int pos, long long v) {
+        uint32_t x = new_node(v);
         auto [A, B] = split_pos(root, pos);
-        root = merge(merge(A, new Node(v, rng())), B);
+        root = merge(merge(A, x), B);
     }
 
     // Erase range [l, r) by position
     void erase_range(int l, int r) {
         auto [A, B] = split_pos(root, l);
         auto [M, C] = split_pos(B, r - l);
-        // Optionally delete M nodes to free memory
+        free_tree(M);
         root = merge(A, C);
     }
 
@@ -233,7 +341,7 @@ struct ImplicitTreap {
     void reverse_range(int l, int r) {
         auto [A, B] = split_pos(root, l);
         auto [M, C] = split_pos(B, r - l);
-        if (M) apply_rev(M);
+        apply_rev(M);
         root = merge(A, merge(M, C));
     }
 
@@ -241,19 +349,31 @@ struct ImplicitTreap {
     long long range_sum(int l, int r) {
         auto [A, B] = split_pos(root, l);
         auto [M, C] = split_pos(B, r - l);
-        long long ans = getsum(M);
+        long long ans = a[M].sum;
         root = merge(A, merge(M, C));
         return ans;
     }
 
-    // Build from vector in O(n log n) expected
-    void build(const vector<long long>& a) {
-        root = nullptr;
-        for (int i = 0; i < (int)a.size(); ++i) insert_at(i, a[i]);
+    // Build from vector in O(n): Cartesian tree by position (stack of the right spine)
+    void build(const vector<long long>& v) {
+        clear();
+        reserve(v.size());
+        stk.clear();
+        for (long long val : v) {
+            uint32_t x = new_node(val), child = 0;
+            while (!stk.empty() && pr(stk.back()) > pr(x)) { child = stk.back(); stk.pop_back(); pull(child); }
+            a[x].l = child;
+            if (!stk.empty()) a[stk.back()].r = x;
+            stk.push_back(x);
+        }
+        for (size_t i = stk.size(); i--; ) pull(stk[i]);
+        root = stk.empty() ? 0 : stk[0];
     }
 
-    int size() const { return getsz(root); }
-    bool empty() const { return root == nullptr; }
+    int size() const { return a[root].sz; }
+    bool empty() const { return root == 0; }
+    void clear() { a.resize(1); freed.clear(); root = 0; }
+    void reserve(size_t n) { a.reserve(n + 1); }
 };
 
 /* ---------------- Example ------------------
@@ -265,6 +385,9 @@ int main(){
     cout << T.order_of_key(5) << "\n";               // 1 (only key 3 is < 5)
     cout << (T.find_by_order(2)->key) << "\n";       // k-th element (0-based)
     T.erase(5);
+    T.build_sorted({1, 2, 2, 8, 9});                 // O(N) bulk load
+    T.insert_sorted({2, 4, 10});                     // union with a sorted batch
+    cout << T.order_of_key(5) << "\n";               // 5 (1,2,2,2,4)
 
     // ImplicitTreap example
     ImplicitTreap IT;
@@ -273,4 +396,3 @@ int main(){
     cout << IT.range_sum(1,4) << "\n"; // 4+3+2 = 9
 }
 ------------------------------------------------*/
-